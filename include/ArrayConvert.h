@@ -0,0 +1,42 @@
+#ifndef PSANA_PYTHON_ARRAYCONVERT_H
+#define PSANA_PYTHON_ARRAYCONVERT_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Functions which post-process arrays returned from get() methods.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/**
+ *  Apply keyword options of get() methods to the object returned from
+ *  event, it steals reference to result and returns new reference or zero
+ *  with Python exception set. Zero or None values of options mean that
+ *  option is not used, None result is returned as is.
+ *
+ *  If dtype is given result is converted to an array of that type, array is
+ *  returned unchanged (sharing data with C++) if its type is already the
+ *  same. Conversion of supported numeric types runs without GIL.
+ *
+ *  If out is given it must be a writeable numpy array with the same shape as
+ *  result (and the same type as dtype if both are given), result data are
+ *  copied into out converting element type if needed and out is returned.
+ */
+PyObject* applyGetOptions(PyObject* result, PyObject* dtype, PyObject* out);
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_ARRAYCONVERT_H
@@ -0,0 +1,125 @@
+#ifndef PSANA_PYTHON_ARRAYPOOL_H
+#define PSANA_PYTHON_ARRAYPOOL_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ArrayPool.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <cstddef>
+#include <boost/shared_ptr.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+namespace PSEvt {
+class ProxyDictI;
+}
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Pool of aligned memory blocks for per-event arrays.
+ *
+ *  Blocks are aligned to Alignment bytes so that SIMD code can use aligned
+ *  loads. Released blocks are kept in free lists by size and are reused for
+ *  arrays of the same size in the following events. Cached blocks are only
+ *  kept for one event: every time an event which used the pool is destroyed
+ *  blocks which were released before the previous event ended and were not
+ *  reused since then are freed, so the pool holds at most the arrays of one
+ *  event when per-event allocations stop. Events are counted separately for
+ *  every thread which makes arrays so that concurrent event loops do not
+ *  free blocks cached by each other. End of event is noticed by the next
+ *  call to numpyEmpty() or asDict() after event and its arrays are gone,
+ *  nothing is stored in the event itself. Total size
+ *  of cached blocks is also limited. Large blocks can optionally be backed
+ *  by transparent huge pages. All methods are thread-safe and do not need
+ *  GIL except numpyEmpty() and asDict().
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class ArrayPool {
+public:
+
+  /// Alignment of all blocks
+  enum { Alignment = 64 };
+
+  /// Returns block of at least size bytes, throws std::bad_alloc on failure
+  static void* allocate(size_t size);
+
+  /// Return block to the pool, size must be the same as in allocate()
+  static void release(void* ptr, size_t size);
+
+  /**
+   *  Returns shared pointer to uninitialized array of count elements, block
+   *  goes back to pool when last copy of pointer is gone. Only for types
+   *  which do not need construction, e.g. ndarray element types.
+   */
+  template <typename T>
+  static boost::shared_ptr<T> makeShared(size_t count) {
+    const size_t size = count * sizeof(T);
+    return boost::shared_ptr<T>(static_cast<T*>(allocate(size)), Deleter(size));
+  }
+
+  /**
+   *  Make numpy array with uninitialized data from the pool, arguments are
+   *  the same as for numpy.empty(). Object dtypes are not allowed. Array is
+   *  accounted to the event with given proxy dictionary, dictionary is only
+   *  referenced weakly. Returns new reference or zero with Python exception set.
+   */
+  static PyObject* numpyEmpty(PyObject* shape, PyObject* dtype,
+                              const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict);
+
+  /// Use huge pages for blocks of 2MB and larger, off by default
+  static void setHugePages(bool enable);
+
+  /// Set limit on total size of cached free blocks
+  static void setCacheLimit(size_t bytes);
+
+  /**
+   *  Return pool state as Python dictionary with keys "allocated", "reused",
+   *  "cached_bytes", "cache_limit" and "hugepages". Returns new reference.
+   */
+  static PyObject* asDict();
+
+private:
+
+  struct Deleter {
+    explicit Deleter(size_t size) : m_size(size) {}
+    void operator()(void* ptr) const { release(ptr, m_size); }
+    size_t m_size;
+  };
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_ARRAYPOOL_H
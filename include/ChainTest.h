@@ -0,0 +1,63 @@
+#ifndef PSANA_PYTHON_CHAINTEST_H
+#define PSANA_PYTHON_CHAINTEST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ChainTest.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana/Module.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief C++ module used by unit tests of Python module chains.
+ *
+ *  Every event gets a string with key "gil:" + module name which tells
+ *  whether GIL was released by the module chain when this module was
+ *  called: "released", "locked" (chain kept GIL for the next Python module)
+ *  or "inactive" (framework does not run inside GILReleaser scope).
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class ChainTest : public psana::Module {
+public:
+
+  // Default constructor
+  ChainTest(const std::string& name);
+
+  // Destructor
+  virtual ~ChainTest();
+
+  /// Method which is called with event data
+  virtual void event(PSEvt::Event& evt, PSEnv::Env& env);
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_CHAINTEST_H
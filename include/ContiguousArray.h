@@ -0,0 +1,159 @@
+#ifndef PSANA_PYTHON_CONTIGUOUSARRAY_H
+#define PSANA_PYTHON_CONTIGUOUSARRAY_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Function template contiguousArray.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <boost/checked_delete.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+#include "pdsdata/xtc/Src.hh"
+#include "psana_python/ConverterStats.h"
+#include "PSEvt/Event.h"
+#include "PSEvt/EventKey.h"
+#include "PSEvt/ProxyDictI.h"
+#include "PSEvt/Source.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+namespace detail {
+
+  // Copy strided data into C-ordered array, returns pointer past last copied element
+  template <typename T>
+  T* copyCOrder(const T* src, T* dst, unsigned rank, const unsigned shape[], const int strides[])
+  {
+    for (unsigned i = 0; i != shape[0]; ++ i, src += strides[0]) {
+      if (rank > 1) {
+        dst = copyCOrder(src, dst, rank-1, shape+1, strides+1);
+      } else {
+        *dst++ = *src;
+      }
+    }
+    return dst;
+  }
+
+  template <typename T, unsigned Rank>
+  bool isCOrder(const ndarray<T, Rank>& arr)
+  {
+    int stride = 1;
+    for (unsigned i = Rank; i > 0; -- i) {
+      if (arr.strides()[i-1] != stride) return false;
+      stride *= arr.shape()[i-1];
+    }
+    return true;
+  }
+
+  /**
+   *  Cache of contiguous copies, kept outside of event so that copies are
+   *  not visible to other consumers. Copies are looked up by event, type,
+   *  source and key of original object and are only valid while the same
+   *  original object is in event. Cache only holds weak reference to event
+   *  dictionary, copies of destroyed events are dropped by next call.
+   */
+  boost::shared_ptr<void> cachedCopy(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict,
+      const std::type_info& type, const Pds::Src& src, const std::string& key,
+      const boost::shared_ptr<void>& original);
+
+  /// Add copy to cache, returns copy made by other thread if there is one already
+  boost::shared_ptr<void> cacheCopy(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict,
+      const std::type_info& type, const Pds::Src& src, const std::string& key,
+      const boost::shared_ptr<void>& original, const boost::shared_ptr<void>& copy);
+
+} // namespace detail
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Return ndarray stored in event with C memory layout.
+ *
+ *  Finds ndarray<const T,Rank> or ndarray<T,Rank> with given source and key,
+ *  it is an error (std::runtime_error) if both exist for the same source,
+ *  same as for conversion to Python. Arrays stored from Python keep numpy
+ *  strides and can be sliced or transposed; if array is not C-contiguous
+ *  then a contiguous copy is made and cached for the lifetime of the event,
+ *  so that only the first consumer pays for the copy and all later consumers
+ *  get the cached one. Copies are not stored in the event and do not appear
+ *  in its keys. Copies are counted in ConverterStats. Copy is made from data
+ *  at the time of first call, it does not follow later modifications of the
+ *  original array, but a new copy is made if the original is replaced.
+ *
+ *  Returns empty pointer if array is not found.
+ */
+template <typename T, unsigned Rank>
+boost::shared_ptr<ndarray<const T, Rank> >
+contiguousArray(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict, const PSEvt::Source& source,
+                const std::string& key = std::string())
+{
+  typedef ndarray<const T, Rank> ConstArray;
+  typedef ndarray<T, Rank> Array;
+
+  Pds::Src foundSrc;
+  boost::shared_ptr<ConstArray> arr;
+  boost::shared_ptr<void> original = proxyDict->get(&typeid(const ConstArray), source, key, &foundSrc);
+  if (original) {
+    if (proxyDict->exists(PSEvt::EventKey(&typeid(const Array), foundSrc, key))) {
+      std::ostringstream msg;
+      msg << "contiguousArray: both const and non-const ndarray found for source="
+          << source << " and key=" << key;
+      throw std::runtime_error(msg.str());
+    }
+    arr = boost::static_pointer_cast<ConstArray>(original);
+  } else if ((original = proxyDict->get(&typeid(const Array), source, key, &foundSrc))) {
+    arr = boost::make_shared<ConstArray>(*boost::static_pointer_cast<Array>(original));
+  } else {
+    return arr;
+  }
+
+  if (detail::isCOrder(*arr)) return arr;
+
+  // copy may be there already
+  if (boost::shared_ptr<void> vdata = detail::cachedCopy(proxyDict, typeid(ConstArray), foundSrc, key, original)) {
+    return boost::static_pointer_cast<ConstArray>(vdata);
+  }
+
+  const size_t size = arr->size();
+  boost::shared_ptr<T> data(new T[size], boost::checked_array_deleter<T>());
+  if (size) detail::copyCOrder(arr->data(), data.get(), Rank, arr->shape(), arr->strides());
+  boost::shared_ptr<ConstArray> copy = boost::make_shared<ConstArray>(boost::shared_ptr<const T>(data), arr->shape());
+
+  // another consumer may have been faster, use its copy
+  boost::shared_ptr<void> cached = detail::cacheCopy(proxyDict, typeid(ConstArray), foundSrc, key, original, copy);
+  if (cached != copy) return boost::static_pointer_cast<ConstArray>(cached);
+  ConverterStats::countContiguous(size * sizeof(T));
+
+  return copy;
+}
+
+/// Same as above, with event as argument
+template <typename T, unsigned Rank>
+boost::shared_ptr<ndarray<const T, Rank> >
+contiguousArray(PSEvt::Event& evt, const PSEvt::Source& source, const std::string& key = std::string())
+{
+  return contiguousArray<T, Rank>(evt.proxyDict(), source, key);
+}
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_CONTIGUOUSARRAY_H
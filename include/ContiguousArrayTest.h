@@ -0,0 +1,67 @@
+#ifndef PSANA_PYTHON_CONTIGUOUSARRAYTEST_H
+#define PSANA_PYTHON_CONTIGUOUSARRAYTEST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ContiguousArrayTest.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana/Module.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Module used by unit tests of contiguousArray().
+ *
+ *  Every event gets ndarray<float,2> with key "contiguous_in" which is a
+ *  transposed 3x4 array (shape 4x3, element [i][j] is 4*j+i). Module calls
+ *  contiguousArray() for it twice and stores the result with key
+ *  "contiguous_out". It also checks that C-ordered array with key
+ *  "contiguous_corder" is returned without copy and that ambiguous key
+ *  "contiguous_both" with const and non-const arrays is an error. Results
+ *  of checks are stored as a string with key "contiguous_test", e.g.
+ *  "same=1 corder=1 ambiguous=1".
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class ContiguousArrayTest : public psana::Module {
+public:
+
+  // Default constructor
+  ContiguousArrayTest(const std::string& name);
+
+  // Destructor
+  virtual ~ContiguousArrayTest();
+
+  /// Method which is called with event data
+  virtual void event(PSEvt::Event& evt, PSEnv::Env& env);
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_CONTIGUOUSARRAYTEST_H
@@ -0,0 +1,107 @@
+#ifndef PSANA_PYTHON_CONVERTERSTATS_H
+#define PSANA_PYTHON_CONVERTERSTATS_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ConverterStats.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <cstddef>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+// Tracepoints in converter hot paths, they are compiled only if the macro
+// PSANA_PYTHON_CONVERTER_TRACE is defined, otherwise they produce no code
+// at all. Message argument uses MsgLog stream syntax.
+#ifdef PSANA_PYTHON_CONVERTER_TRACE
+#include "MsgLogger/MsgLogger.h"
+#define PSANA_PYTHON_CVT_TRACE(logger, msg) MsgLog(logger, debug, msg)
+#else
+#define PSANA_PYTHON_CVT_TRACE(logger, msg) do {} while (false)
+#endif
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Counters for array conversions between C++ and Python.
+ *
+ *  Counters are updated with atomic increments and can be used from any
+ *  thread without GIL. Conversions are counted by direction, NumPy type
+ *  number and rank; zero-copy conversions also count the number of bytes
+ *  shared between C++ and Python; rejected conversions are counted by
+ *  reason. Python code reads them with _psana.converterStats().
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class ConverterStats {
+public:
+
+  /// Direction of conversion
+  enum Direction { ToNumpy, FromNumpy, NumDirections };
+
+  /// Reason for rejecting conversion in convertible() methods
+  enum Reject { NotArray, WrongRank, WrongType, WrongObject, NumRejects };
+
+  /**
+   *  Count one conversion. Type name is a static string (e.g. "float64"),
+   *  zeroCopyBytes is the size of data shared without copying, zero if
+   *  data were copied.
+   */
+  static void count(Direction dir, int numpyType, const char* typeName, unsigned rank, size_t zeroCopyBytes);
+
+  /// Count bytes copied during conversion
+  static void countCopy(size_t bytes);
+
+  /// Count contiguous copy of strided ndarray made by contiguousArray()
+  static void countContiguous(size_t bytes);
+
+  /// Count rejected conversion
+  static void reject(Reject reason);
+
+  /**
+   *  Return all counters as Python dictionary:
+   *  {"to_numpy": {(type, rank): count}, "from_numpy": {(type, rank): count},
+   *   "zero_copy_bytes": int, "copied_bytes": int, "contiguous_copies": int,
+   *   "contiguous_bytes": int, "rejected": {reason: count}}
+   *  Returns new reference.
+   */
+  static PyObject* asDict();
+
+  /// Reset all counters to zero
+  static void reset();
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_CONVERTERSTATS_H
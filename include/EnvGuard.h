@@ -0,0 +1,96 @@
+#ifndef PSANA_PYTHON_ENVGUARD_H
+#define PSANA_PYTHON_ENVGUARD_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class EnvGuard.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <boost/shared_ptr.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+namespace PSEnv {
+class Env;
+}
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Guard for environment objects updated by background thread.
+ *
+ *  When psana module chain runs in a background thread (event prefetch)
+ *  that thread updates configuration, calibration and EPICS stores and alias
+ *  map of the environment for the next event while Python code still works
+ *  on the current one. Environment is not thread-safe and there is no way to
+ *  take a snapshot of it, so objects which run the chain in background
+ *  register themselves as clients of the environment. Python wrappers of
+ *  environment objects call use() which waits until background clients of
+ *  that environment finish reading current event and stops their read-ahead,
+ *  after that the chain only runs while Python code waits for the next
+ *  event. Python modules in the chain run in background thread and are not
+ *  affected.
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class EnvGuard {
+public:
+
+  /// Interface of objects which update environment in background thread
+  class Client {
+  public:
+
+    virtual ~Client() {}
+
+    /// Wait until background update is finished and do not start new ones, called without GIL
+    virtual void stopBackground() = 0;
+
+  };
+
+  /// Register client which updates environment in background, registry keeps weak reference,
+  /// client which is registered already is not added again
+  static void add(PSEnv::Env& env, const boost::shared_ptr<Client>& client);
+
+  /// Mark calling thread as background thread of a client
+  static void setBackground();
+
+  /**
+   *  Make environment object (store or alias map) safe to use from calling
+   *  thread, stops background updates of its environment. Does nothing when
+   *  called from background thread. Must be called with GIL held, GIL is
+   *  released while waiting for background thread.
+   */
+  static void use(const void* obj);
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_ENVGUARD_H
@@ -0,0 +1,117 @@
+#ifndef PSANA_PYTHON_GILRELEASER_H
+#define PSANA_PYTHON_GILRELEASER_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Classes GILReleaser and GILLocker.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <boost/utility.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Scope which releases Python GIL while C++ code runs psana modules.
+ *
+ *  Constructor releases GIL and destructor restores it. While the scope is
+ *  active Python modules called by the framework on the same thread take
+ *  GIL back with acquire() and give it away with release(). A sequence of
+ *  consecutive Python modules calls acquire() once and release() only when
+ *  the next module is a C++ module, so GIL is not bounced between every two
+ *  Python modules. If GIL is still held by the module chain when the scope
+ *  ends then destructor simply keeps it.
+ *
+ *  Scopes can be nested, e.g. when a Python module iterates over events
+ *  from another data source.
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class GILReleaser : boost::noncopyable {
+public:
+
+  /// Constructor releases GIL, must be called with GIL held
+  GILReleaser();
+
+  /// Destructor locks GIL again unless it is already locked by module chain
+  ~GILReleaser();
+
+  /// Returns true if calling thread is inside GILReleaser scope
+  static bool active();
+
+  /// Returns true if calling thread is inside scope and has GIL locked
+  static bool locked();
+
+  /// Lock GIL released by the active scope, no-op if it is locked already
+  static void acquire();
+
+  /// Release GIL locked by acquire(), no-op if it is not locked
+  static void release();
+
+protected:
+
+private:
+
+  // Data members
+  PyThreadState* m_prevState;  // saved state of enclosing scope
+  bool m_prevActive;           // true if there is enclosing scope
+
+};
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Scope which ensures that GIL is locked by calling thread.
+ *
+ *  Thin wrapper for PyGILState_Ensure()/PyGILState_Release(), can be used
+ *  from any thread including threads not created by Python, and inside
+ *  GILReleaser scope.
+ */
+
+class GILLocker : boost::noncopyable {
+public:
+
+  GILLocker() : m_gilState(PyGILState_Ensure()) {}
+
+  ~GILLocker() { PyGILState_Release(m_gilState); }
+
+private:
+
+  PyGILState_STATE m_gilState;
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_GILRELEASER_H
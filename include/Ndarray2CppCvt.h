@@ -41,7 +41,10 @@ namespace psana_python {
  *  @brief Implementation of converters for C++ ndarray type.
  *
  *  This class is responsible for conversion of Python numpy.ndarray type
- *  into C++ ndarray. For opposite direction check NdarrayCvt class.
+ *  into C++ ndarray. For opposite direction check NdarrayCvt class. Other
+ *  objects which export buffer protocol are converted by convertBuffer().
+ *  Data are shared with Python object, read-only arrays become ndarrays with
+ *  const elements, data with non-native byte order are copied once.
  *
  *  @note This software was developed for the LCLS project.  If you use all or 
  *  part of it, please give an appropriate acknowledgment.
@@ -102,6 +105,24 @@ public:
    */
   virtual bool convert(PyObject* obj, PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key) const;
 
+  /**
+   *  @brief Convert any object exporting buffer protocol to C++ ndarray
+   *
+   *  Buffer view is held until ndarray data are released, buffer must have
+   *  simple format (one item of supported numeric type) and rank 1 to 6.
+   *  Can throw PSEvt::ExceptionDuplicateKey.
+   *
+   *  @return True for successful conversion, false otherwise (no Python exception is set)
+   */
+  static bool convertBuffer(PyObject* obj, PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key);
+
+  /**
+   *  @brief Return C++ type of ndarray which convertBuffer() makes from an object
+   *
+   *  @return Zero pointer if object cannot be converted (no Python exception is set)
+   */
+  static const std::type_info* bufferArrayType(PyObject* obj);
+
 protected:
 
 private:
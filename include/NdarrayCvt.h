@@ -13,6 +13,7 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <string>
 
 //----------------------
 // Base Class Headers --
@@ -45,6 +46,13 @@ namespace psana_python {
  *
  *  @brief Implementation of converters for C++ ndarray type.
  *
+ *  All supported element types and ranks are described by a single table,
+ *  each row knows C++ types of the ndarray (const and non-const elements),
+ *  its wrapper Python type and a function which makes numpy array. One
+ *  instance of this class converts to numpy.ndarray and dispatches on the
+ *  types of objects found in the event for a given source and key, other
+ *  instances each handle one wrapper type (e.g. ndarray_float64_2).
+ *
  *  @note This software was developed for the LCLS project.  If you use all or 
  *  part of it, please give an appropriate acknowledgment.
  *
@@ -53,12 +61,17 @@ namespace psana_python {
  *  @author Andy Salnikov
  */
 
-template <typename T, unsigned Rank>
 class NdarrayCvt : public psddl_python::Converter {
 public:
 
-  // Default constructor
-  NdarrayCvt (PyObject* module) ;
+  /// Row in a table of supported ndarray types, defined in source file
+  struct Entry;
+
+  /// Constructor for converter to numpy.ndarray which handles all types
+  NdarrayCvt () ;
+
+  /// Constructor for converter to a single wrapper type
+  explicit NdarrayCvt (const Entry* entry) ;
 
   // Destructor
   virtual ~NdarrayCvt () ;
@@ -103,13 +116,13 @@ protected:
 private:
 
   // Data members
-
+  const Entry* m_entry;  // zero for numpy.ndarray converter
 
 };
 
 /**
- *  Method that registers converters for all supported types, this will also
- *  create all necessary data types.
+ *  Method that registers converters for all supported types and adds Python
+ *  wrapper types (e.g. ndarray_float64_2) to a module.
  */
 void initNdarrayCvt(psddl_python::ConverterMap& cmap, PyObject* module);
 
@@ -0,0 +1,77 @@
+#ifndef PSANA_PYTHON_NDARRAYKEEPTEST_H
+#define PSANA_PYTHON_NDARRAYKEEPTEST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class NdarrayKeepTest.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include "python/Python.h"
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana/Module.h"
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Module used by unit tests of lifetime of numpy arrays converted
+ *  to ndarray by BOOST converter.
+ *
+ *  First event converts numpy.arange(3.) to ndarray<const double,1> and
+ *  keeps only the ndarray, third event destroys it without taking GIL.
+ *  Every event gets a string with key "ndarray_keep_test", "alive=1" if
+ *  numpy array still exists followed by " values=0 1 2" while ndarray is
+ *  kept, e.g. "alive=1 values=0 1 2" or "alive=0".
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class NdarrayKeepTest : public psana::Module {
+public:
+
+  // Default constructor
+  NdarrayKeepTest(const std::string& name);
+
+  // Destructor
+  virtual ~NdarrayKeepTest();
+
+  /// Method which is called with event data
+  virtual void event(PSEvt::Event& evt, PSEnv::Env& env);
+
+private:
+
+  unsigned m_count;                 // number of events seen
+  ndarray<const double, 1> m_kept;  // ndarray made from numpy array
+  PyObject* m_weakref;              // weak reference to numpy array
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_NDARRAYKEEPTEST_H
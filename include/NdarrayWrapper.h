@@ -0,0 +1,153 @@
+#ifndef PSANA_PYTHON_NDARRAYWRAPPER_H
+#define PSANA_PYTHON_NDARRAYWRAPPER_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class NdarrayWrapper and ndarray element type traits.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <boost/lexical_cast.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "pytools/PyDataType.h"
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+// Set of ranks and element types for which converters are instantiated, if
+// you extend PSANA_PYTHON_ND_TYPES also add specialization of NdarrayTraits
+#define PSANA_PYTHON_ND_RANKS (1)(2)(3)(4)(5)(6)
+#define PSANA_PYTHON_ND_TYPES (int8_t)(uint8_t)(int16_t)(uint16_t)(int32_t)(uint32_t)(int64_t)(uint64_t)(float)(double)
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Traits for C++ types supported as ndarray elements.
+ *
+ *  Defines Python type name and NumPy type number, the same traits are used
+ *  for const element types. NumPy headers must be included before this file.
+ */
+template <typename T> struct NdarrayTraits {};
+template <typename T> struct NdarrayTraits<const T> : NdarrayTraits<T> {};
+
+#define PSANA_PYTHON_ND_TRAITS(TYPE, NAME, NPYTYPE) \
+  template <> struct NdarrayTraits<TYPE> { \
+    static const char* typeName() { return NAME; } \
+    static int numpyType() { return NPYTYPE; } \
+  };
+
+PSANA_PYTHON_ND_TRAITS(int8_t, "int8", NPY_INT8)
+PSANA_PYTHON_ND_TRAITS(uint8_t, "uint8", NPY_UINT8)
+PSANA_PYTHON_ND_TRAITS(int16_t, "int16", NPY_INT16)
+PSANA_PYTHON_ND_TRAITS(uint16_t, "uint16", NPY_UINT16)
+PSANA_PYTHON_ND_TRAITS(int32_t, "int32", NPY_INT32)
+PSANA_PYTHON_ND_TRAITS(uint32_t, "uint32", NPY_UINT32)
+PSANA_PYTHON_ND_TRAITS(int64_t, "int64", NPY_INT64)
+PSANA_PYTHON_ND_TRAITS(uint64_t, "uint64", NPY_UINT64)
+PSANA_PYTHON_ND_TRAITS(float, "float32", NPY_FLOAT32)
+PSANA_PYTHON_ND_TRAITS(double, "float64", NPY_FLOAT64)
+
+#undef PSANA_PYTHON_ND_TRAITS
+
+/// Returns true if strides (in elements) correspond to C memory layout
+template <unsigned Rank>
+inline bool isCArray(const unsigned shape[], const int strides[])
+{
+  int stride = 1;
+  for (int i = Rank; i > 0; -- i) {
+    if (strides[i-1] != stride) return false;
+    stride *= shape[i-1];
+  }
+  return true;
+}
+
+/**
+ *  Returns module in which wrapper types are registered, it is set by
+ *  initNdarrayCvt() and is zero before that.
+ */
+PyObject* ndarrayWrapperModule();
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Python type which holds C++ ndarray objects.
+ *
+ *  Instances of this type are used as base objects of numpy arrays which
+ *  share data with C++ ndarrays, the type itself can be passed to Event.get()
+ *  to select ndarrays of particular element type and rank. Python types are
+ *  initialized by readyType() which initNdarrayCvt() calls for all types,
+ *  ndarrays with const and non-const elements share the same wrapper type.
+ */
+template <typename T, unsigned Rank>
+class NdarrayWrapper : public pytools::PyDataType<NdarrayWrapper<T, Rank>, ndarray<const T, Rank> > {
+public:
+
+  typedef pytools::PyDataType<NdarrayWrapper, ndarray<const T, Rank> > BaseType;
+
+  /// Returns Python type name, e.g. "ndarray_float64_2"
+  static std::string typeName() {
+    return std::string("ndarray_") + NdarrayTraits<T>::typeName() + "_" + boost::lexical_cast<std::string>(Rank);
+  }
+
+  /// Initialize Python type (once) and return it, borrowed reference
+  static PyTypeObject* readyType() {
+    static bool ready __attribute__((unused)) = initType(ndarrayWrapperModule());
+    return BaseType::typeObject();
+  }
+
+  /// Make Python object holding a copy of ndarray, new reference
+  static PyObject* wrap(const ndarray<const T, Rank>& arr) {
+    readyType();
+    return BaseType::PyObject_FromCpp(arr);
+  }
+
+  // Dump object info to a stream
+  void print(std::ostream& out) const {
+    out << this->m_obj;
+  }
+
+private:
+
+  // Initialize Python type and register it in a module
+  static bool initType(PyObject* module) {
+
+    static char typedoc[] = "Special Python type which wraps C++ ndarray. "
+        "The instances of this type are not used directly, but the type itself is used as "
+        "an argument for Event.get() method.";
+
+    static std::string name = typeName();
+
+    PyTypeObject* type = BaseType::typeObject();
+    type->tp_doc = typedoc;
+
+    BaseType::initType(name.c_str(), module, "psana");
+    return true;
+  }
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_NDARRAYWRAPPER_H
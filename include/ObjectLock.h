@@ -0,0 +1,83 @@
+#ifndef PSANA_PYTHON_OBJECTLOCK_H
+#define PSANA_PYTHON_OBJECTLOCK_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ObjectLock.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <boost/utility.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Per-object lock for C++ objects shared between Python threads.
+ *
+ *  Iterators and event data are used by C++ code which runs without GIL
+ *  (in GILReleaser scope), so GIL alone does not serialize access to them.
+ *  Constructor locks a mutex which belongs to given object only, mutexes
+ *  are created on first use and destroyed when the last lock of the object
+ *  is gone, so unrelated objects never share a mutex. Locks are re-entrant
+ *  for the same thread. If the mutex is busy and calling thread holds GIL
+ *  then GIL is released while waiting, the lock stays locked while GIL is
+ *  released later (e.g. in GILReleaser scope).
+ *
+ *  When several locks are needed they must be taken in the order of Domain
+ *  values to avoid deadlocks.
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class ObjectLock : boost::noncopyable {
+public:
+
+  /// Kinds of locked objects, in the order of locking
+  enum Domain { Iterator, TypeObject, ProxyDict, Converters, NumDomains };
+
+  /// Lock mutex for given object
+  ObjectLock(const void* obj, Domain domain);
+
+  /// Unlock mutex
+  ~ObjectLock();
+
+private:
+
+  // Data members
+  void* m_entry;
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_OBJECTLOCK_H
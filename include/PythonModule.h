@@ -13,11 +13,14 @@
 // C/C++ Headers --
 //-----------------
 #include <python/Python.h>
+#include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 //----------------------
 // Base Class Headers --
 //----------------------
+#include "psana/Context.h"
 #include "psana/Module.h"
 
 //-------------------------------
@@ -63,35 +66,78 @@ public:
 
   virtual ~PythonModule();
 
+  /**
+   *   Register module in the module chain of its framework, needed to keep
+   *   GIL locked between consecutive Python modules. loaderName is the name
+   *   which psana loader passed to moduleFactory(), empty for modules added
+   *   through DataSource. Only the first call has effect.
+   */
+  void addToChain(const std::string& loaderName);
+
   // Standard module methods -- see psana/Module.h
   virtual void beginJob(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethBeginJob].get(), false, evt, env);
+    call(MethBeginJob, false, evt, env);
   }
 
   virtual void beginRun(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethBeginRun].get(), false, evt, env);
+    call(MethBeginRun, false, evt, env);
   }
 
   virtual void beginCalibCycle(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethBeginScan].get(), false, evt, env);
+    call(MethBeginScan, false, evt, env);
   }
 
   virtual void event(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethEvent].get(), false, evt, env);
+    call(MethEvent, false, evt, env);
   }
 
   virtual void endCalibCycle(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethEndScan].get(), m_pyanaCompat, evt, env);
+    call(MethEndScan, m_pyanaCompat, evt, env);
   }
 
   virtual void endRun(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethEndRun].get(), m_pyanaCompat, evt, env);
+    call(MethEndRun, m_pyanaCompat, evt, env);
   }
 
   virtual void endJob(PSEvt::Event& evt, PSEnv::Env& env) {
-    call(m_methods[MethEndJob].get(), false, evt, env);
+    call(MethEndJob, false, evt, env);
   }
 
+  /**
+   *  Event data declared by the module in its "produces" or "consumes"
+   *  attribute. Each item of the attribute is either a key string, or a
+   *  tuple with the same meaning as arguments of Event.get(): (type,),
+   *  (type, key), (type, src) or (type, src, key), where type can be None
+   *  to match any type. If psana.check_declarations option is set then
+   *  declared inputs are checked before and outputs after every event()
+   *  call, and declarations which are not satisfied are reported.
+   */
+  struct DataDeclaration {
+    pytools::pyshared_ptr type;  ///< Python type, empty for any type
+    pytools::pyshared_ptr src;   ///< Source object, empty for any source
+    std::string key;             ///< event key string
+    std::string text;            ///< repr() of declaration for messages
+    bool warned;                 ///< mismatch was reported already
+  };
+
+  /// Event data written by module, empty if nothing was declared
+  const std::vector<DataDeclaration>& produces() const { return m_produces; }
+
+  /// Event data read by module, empty if nothing was declared
+  const std::vector<DataDeclaration>& consumes() const { return m_consumes; }
+
+  /// Returns dictionary caching results of configXxx() accessors, borrowed reference
+  PyObject* configCache() const { return m_configCache.get(); }
+
+  /// Returns true while module event() method is running
+  bool inEvent() const { return m_inEvent; }
+
+  /**
+   *  Returns true if config accessor calls inside event() need to be reported
+   *  (psana.warn_config_in_event option), only the first call returns true.
+   */
+  bool warnConfigInEvent() { bool warn = m_warnConfigInEvent; m_warnConfigInEvent = false; return warn; }
+
   // need to expose few protected methods to allow python code access to them
   using Configurable::name;
   using Configurable::className;
@@ -99,34 +145,52 @@ public:
   using Configurable::configStr;
   using Configurable::configSrc;
   using Configurable::configList;
-  using psana::Module::skip;
-  using psana::Module::stop;
-  using psana::Module::terminate;
+
+  // these also tell call() that downstream modules will not run for this event
+  void skip() { m_chainBroken = true; psana::Module::skip(); }
+  void stop() { m_chainBroken = true; psana::Module::stop(); }
+  void terminate() { m_chainBroken = true; psana::Module::terminate(); }
 
 private:
   /**
-   * class to ensure the GIL is locked and then restore it.
-   * Intended to be used before/after calling the PythonModule functions.
+   *   Method to call Python method with event and env args.
+   *
+   *   @param[in] meth  Index of the method in m_methods
+   *   @param[in] pyana_optional_evt  If true then method may take only env argument
    */
-  class GILLocker {
-    public:
-      GILLocker() : m_gilState(PyGILState_Ensure()) {}
-    
-      ~GILLocker() {
-        PyGILState_Release(m_gilState);
-      }
-    
-    private:
-      PyGILState_STATE m_gilState;
-  };
-  
+  void call(int meth, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env);
+
   /**
-   *   Method to call provided Python method with event and env args.
-   *
-   *   @param[in] psana_method  Python method for psana-style modules
-   *   @param[in] psana_method  Python method for psana-style modules
+   *   Does actual call of Python method, GIL must be locked.
+   */
+  void invoke(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env);
+
+  /**
+   *   Find position of this module in psana module chain, this is needed to
+   *   keep GIL locked when next module is also Python module. Position is
+   *   found again if psana.modules or the set of Python modules of the
+   *   framework was changed since the last call.
+   */
+  void findChainPosition();
+
+  /**
+   *   Make read-only "config" attribute of Python instance with all
+   *   module parameters converted to Python types.
+   */
+  void makeConfigSnapshot();
+
+  /**
+   *   Read sequence of data declarations from Python attribute, items which
+   *   cannot be parsed are reported and ignored.
+   */
+  void readDeclarations(const char* attr, std::vector<DataDeclaration>& decls);
+
+  /**
+   *   Check that declared data are present in event, report each missing
+   *   declaration once. Used when psana.check_declarations is set.
    */
-  void call(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env);
+  void checkDeclarations(std::vector<DataDeclaration>& decls, PSEvt::Event& evt, PyObject* pyevt,
+      const char* what);
 
   enum { MethBeginJob, MethBeginRun, MethBeginScan, MethEvent,
     MethEndScan, MethEndRun, MethEndJob, NumMethods };
@@ -135,6 +199,21 @@ private:
   bool m_pyanaCompat;        // True if env var PYANA_COMPAT is set.
                              // Enables various pyana-compatible hacks.
   pytools::pyshared_ptr m_methods[NumMethods];  // method objects
+  psana::Context::context_t m_context;  // context (framework instance) in which module was made
+  std::string m_loaderName;  // name passed to moduleFactory() by loader, empty if added by DataSource
+  bool m_inChain;            // true after addToChain() was called
+  std::string m_chainModules;  // value of psana.modules used by findChainPosition()
+  unsigned long m_chainGeneration;  // state of module registry used by findChainPosition()
+  bool m_chainKnown;         // true after findChainPosition() was called
+  bool m_nextIsPython;       // next module in the chain is a Python module
+  bool m_lastInChain;        // this is the last module in the chain
+  bool m_chainBroken;        // module called skip()/stop()/terminate() in current call
+  std::vector<DataDeclaration> m_produces;  // declared output data
+  std::vector<DataDeclaration> m_consumes;  // declared input data
+  bool m_checkDeclarations;  // check declared data for every event
+  pytools::pyshared_ptr m_configCache;  // cached results of config accessors
+  bool m_inEvent;            // true while event() is running
+  bool m_warnConfigInEvent;  // report config accessors called from event()
 
 };
 
@@ -0,0 +1,88 @@
+#ifndef PSANA_PYTHON_STARTUPTRACE_H
+#define PSANA_PYTHON_STARTUPTRACE_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StartupTrace.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <vector>
+#include <boost/utility.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Timing of job startup phases.
+ *
+ *  Records wall-clock time spent in startup phases such as initialization
+ *  of _psana module and import of every user module. Instances of this class
+ *  measure one phase from construction to destruction, recorded phases are
+ *  printed to the log at debug level and can be retrieved from Python with
+ *  _psana.startupTrace().
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class StartupTrace : boost::noncopyable {
+public:
+
+  /// One recorded phase
+  struct Entry {
+    std::string phase;
+    double start;     ///< seconds since library was loaded
+    double duration;  ///< seconds
+  };
+
+  /// Start timing of the phase
+  explicit StartupTrace(const std::string& phase);
+
+  /// Record the phase
+  ~StartupTrace();
+
+  /// Returns copy of recorded phases in the order they finished, only first 1000 phases are kept
+  static std::vector<Entry> entries();
+
+protected:
+
+private:
+
+  // Data members
+  std::string m_phase;
+  double m_start;
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_STARTUPTRACE_H
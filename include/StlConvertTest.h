@@ -0,0 +1,65 @@
+#ifndef PSANA_PYTHON_STLCONVERTTEST_H
+#define PSANA_PYTHON_STLCONVERTTEST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StlConvertTest.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana/Module.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Module used by unit tests of BOOST converters for STL containers.
+ *
+ *  Every event gets Python objects made by BOOST to-python converters
+ *  from C++ containers: "stl_vector" from vector<double> {1.5, 2.5},
+ *  "stl_deque" from deque<int32_t> {1, 2, 3}, "stl_list" from
+ *  list<uint16_t> {7, 8}, "stl_pairs" from vector<pair<float,float>>
+ *  {(1, 2), (3, 4)}, "stl_strings" from vector<string> {"a", "bc", ""}
+ *  and "stl_empty" from empty vector<int64_t>.
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class StlConvertTest : public psana::Module {
+public:
+
+  // Default constructor
+  StlConvertTest(const std::string& name);
+
+  // Destructor
+  virtual ~StlConvertTest();
+
+  /// Method which is called with event data
+  virtual void event(PSEvt::Event& evt, PSEnv::Env& env);
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_STLCONVERTTEST_H
@@ -0,0 +1,189 @@
+#ifndef PSANA_PYTHON_STRUCTDTYPE_H
+#define PSANA_PYTHON_STRUCTDTYPE_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Registration of C++ structs as numpy structured dtypes.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include "python/Python.h"
+#include <cstddef>
+#include <string>
+#include <typeinfo>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_pod.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+#include "pdsdata/xtc/Src.hh"
+#include "PSEvt/DataProxy.h"
+#include "PSEvt/ProxyDictI.h"
+
+// Describes one data member of a struct for registerStructDtype(), format
+// is a numpy type string, e.g. PSANA_PYTHON_STRUCT_FIELD(Peak, x, "f4")
+#define PSANA_PYTHON_STRUCT_FIELD(STRUCT, MEMBER, FORMAT) \
+  { #MEMBER, FORMAT, offsetof(STRUCT, MEMBER), sizeof(((STRUCT*)0)->MEMBER) }
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// One field of registered struct, use PSANA_PYTHON_STRUCT_FIELD to fill it
+struct StructField {
+  const char* name;
+  const char* format;
+  size_t offset;
+  size_t size;
+};
+
+/// Maximum rank of ndarrays of structs which get converters
+enum { StructMaxRank = 6 };
+
+/**
+ *  Type-erased operations on ndarray<Struct,Rank> for one rank, filled by
+ *  registerStructDtype() template.
+ */
+struct StructRankOps {
+
+  /// type_infos of ndarray<Struct,Rank> and ndarray<const Struct,Rank>
+  const std::type_info* type;
+  const std::type_info* constType;
+
+  /// Make numpy array sharing data with ndarray stored in event, new reference
+  PyObject* (*toNumpy)(const boost::shared_ptr<void>& vdata, bool isConst, PyObject* dtype);
+
+  /// Store ndarray which shares data with owner in event, strides are in elements
+  void (*save)(const boost::shared_ptr<void>& owner, void* data, const unsigned shape[], const int strides[],
+      PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key, bool modifiable);
+};
+
+/**
+ *  Implementation of registerStructDtype(). Checks struct layout (field types
+ *  must match their C++ sizes, be aligned and not overlap, struct size is
+ *  the item size), makes numpy dtype and registers converters. Returns
+ *  false and logs error if layout check fails. Must be called with GIL held
+ *  after _psana module is initialized.
+ */
+bool registerStructDtype(const std::type_info& type, const std::string& name, size_t size,
+    const StructField fields[], size_t nfields, const StructRankOps ops[StructMaxRank]);
+
+/**
+ *  Returns numpy dtype registered for struct type, or zero. Borrowed reference.
+ */
+PyObject* structDtype(const std::type_info& type);
+
+/**
+ *  Make numpy array of registered struct type which shares data with C++,
+ *  owner keeps data alive, strides are in elements. Returns new reference.
+ */
+PyObject* structArrayToNumpy(PyObject* dtype, unsigned rank, const unsigned shape[], const int strides[],
+    size_t itemsize, const void* data, const boost::shared_ptr<void>& owner, bool writeable);
+
+namespace detail {
+
+  template <typename Struct, unsigned Rank>
+  PyObject* structToNumpy(const boost::shared_ptr<void>& vdata, bool isConst, PyObject* dtype)
+  {
+    // both const and non-const ndarrays have the same layout
+    typedef ndarray<const Struct, Rank> ConstArray;
+    typedef ndarray<Struct, Rank> Array;
+    if (isConst) {
+      const ConstArray& arr = *static_cast<const ConstArray*>(vdata.get());
+      return structArrayToNumpy(dtype, Rank, arr.shape(), arr.strides(), sizeof(Struct), arr.data(), vdata, false);
+    } else {
+      const Array& arr = *static_cast<const Array*>(vdata.get());
+      return structArrayToNumpy(dtype, Rank, arr.shape(), arr.strides(), sizeof(Struct), arr.data(), vdata, true);
+    }
+  }
+
+  template <typename Struct, unsigned Rank>
+  void structSave(const boost::shared_ptr<void>& owner, void* data, const unsigned shape[], const int strides[],
+      PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key, bool modifiable)
+  {
+    boost::shared_ptr<PSEvt::ProxyI> proxyPtr;
+    const std::type_info* tinfo = 0;
+    boost::shared_ptr<Struct> dataptr(owner, static_cast<Struct*>(data));
+    if (modifiable) {
+      typedef ndarray<Struct, Rank> ArrayType;
+      boost::shared_ptr<ArrayType> parray = boost::make_shared<ArrayType>(dataptr, shape);
+      parray->strides(strides);
+      proxyPtr = boost::make_shared<PSEvt::DataProxy<ArrayType> >(parray);
+      tinfo = &typeid(const ArrayType);
+    } else {
+      typedef ndarray<const Struct, Rank> ArrayType;
+      boost::shared_ptr<ArrayType> parray = boost::make_shared<ArrayType>(dataptr, shape);
+      parray->strides(strides);
+      proxyPtr = boost::make_shared<PSEvt::DataProxy<ArrayType> >(parray);
+      tinfo = &typeid(const ArrayType);
+    }
+    // this may throw
+    proxyDict.put(proxyPtr, PSEvt::EventKey(tinfo, source, key));
+  }
+
+  template <typename Struct, unsigned Rank>
+  struct StructRanks {
+    static void fill(StructRankOps ops[]) {
+      StructRankOps& op = ops[Rank-1];
+      op.type = &typeid(const ndarray<Struct, Rank>);
+      op.constType = &typeid(const ndarray<const Struct, Rank>);
+      op.toNumpy = &structToNumpy<Struct, Rank>;
+      op.save = &structSave<Struct, Rank>;
+      StructRanks<Struct, Rank-1>::fill(ops);
+    }
+  };
+
+  template <typename Struct>
+  struct StructRanks<Struct, 0> {
+    static void fill(StructRankOps[]) {}
+  };
+
+} // namespace detail
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Register C++ struct as numpy structured dtype.
+ *
+ *  After registration ndarray<Struct,Rank> and ndarray<const Struct,Rank>
+ *  objects in event are returned to Python as numpy arrays with structured
+ *  dtype sharing data with C++, Python type to use in Event.get() is
+ *  _psana.ndarray_<name>_<rank>. Numpy arrays with the same dtype stored with
+ *  Event.put() become ndarrays of Struct without copying. Struct must be a
+ *  POD type, layout is checked once here, e.g.:
+ *
+ *  @code
+ *  struct Peak { float x, y; uint32_t npix; };
+ *  const StructField fields[] = { PSANA_PYTHON_STRUCT_FIELD(Peak, x, "f4"),
+ *      PSANA_PYTHON_STRUCT_FIELD(Peak, y, "f4"), PSANA_PYTHON_STRUCT_FIELD(Peak, npix, "u4") };
+ *  registerStructDtype<Peak>("peak", fields, 3);
+ *  @endcode
+ *
+ *  Must be called with GIL held after _psana module is initialized, returns
+ *  false if layout check fails or struct name is registered already.
+ */
+template <typename Struct>
+bool registerStructDtype(const std::string& name, const StructField fields[], size_t nfields)
+{
+  BOOST_STATIC_ASSERT(boost::is_pod<Struct>::value);
+
+  StructRankOps ops[StructMaxRank];
+  detail::StructRanks<Struct, StructMaxRank>::fill(ops);
+  return registerStructDtype(typeid(Struct), name, sizeof(Struct), fields, nfields, ops);
+}
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_STRUCTDTYPE_H
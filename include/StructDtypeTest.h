@@ -0,0 +1,74 @@
+#ifndef PSANA_PYTHON_STRUCTDTYPETEST_H
+#define PSANA_PYTHON_STRUCTDTYPETEST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StructDtypeTest.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana/Module.h"
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace psana_python {
+
+/// @addtogroup psana_python
+
+/**
+ *  @ingroup psana_python
+ *
+ *  @brief Module used by unit tests of registerStructDtype().
+ *
+ *  First beginJob() in a process registers test struct as "testpeak" after
+ *  trying several field tables with wrong layout, results of all attempts
+ *  are stored in every event as a string with key "struct_dtype_test", e.g.
+ *  "bad_size=0 misaligned=0 overlap=0 outside=0 good=1 duplicate=0". Every
+ *  event also gets ndarray<TestPeak,1> with key "peaks1" and
+ *  ndarray<const TestPeak,2> with key "peaks2", element i has x=i, y=2*i,
+ *  npix=10+i, flags=i, charge=-i and sum=0.5*i. Key "peaks_both" has
+ *  both ndarray<TestPeak,1> and ndarray<const TestPeak,1>.
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class StructDtypeTest : public psana::Module {
+public:
+
+  // Default constructor
+  StructDtypeTest(const std::string& name);
+
+  // Destructor
+  virtual ~StructDtypeTest();
+
+  /// Method which is called once at the beginning of the job
+  virtual void beginJob(PSEvt::Event& evt, PSEnv::Env& env);
+
+  /// Method which is called with event data
+  virtual void event(PSEvt::Event& evt, PSEnv::Env& env);
+
+private:
+
+  std::string m_results;  // results of registration attempts
+
+};
+
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_STRUCTDTYPETEST_H
@@ -4,6 +4,8 @@
 #include <boost/python.hpp>
 #include <ndarray/ndarray.h>
 #include <list>
+#include <string>
+#include <vector>
 
 
 namespace psana_python {
@@ -22,7 +24,8 @@ namespace psana_python {
   };
   
   
-  // Converter for Numpy to NDArray for BOOST
+  // Converter for Numpy to NDArray for BOOST, NDArray shares data with
+  // Numpy array and keeps a reference to it, C++ code can keep the NDArray
   template <typename T, unsigned Rank> struct NumpyToNDArray
   {
     // Registers Numpy to NDArray converter with BOOST
@@ -37,15 +40,38 @@ namespace psana_python {
   };
 
   
-  // Converter for STL list<ndtypes> to Numpy for BOOST
-  // where ndtypes is defined by the macro ND_TYPES (see source file)
-  template <typename T> struct StlListToNumpy
+  // Converter for STL sequences (vector, deque, list) to 1-dimensional
+  // Numpy arrays for BOOST. Supported elements are ndtypes (see
+  // PSANA_PYTHON_ND_TYPES in NdarrayWrapper.h) and std::pair<ndtype,ndtype>
+  // for vectors (structured dtype with fields "first" and "second"). Data
+  // are copied in bulk. Converter is not registered for types which already
+  // have BOOST to-python converter, e.g. from other extension module.
+  template <typename Container> struct StlSeqToNumpy
+  {
+    // Converts STL sequence to Numpy for boost
+    static PyObject* convert(Container const& seq);
+
+    // Register STL sequence to Numpy converter with BOOST
+    static void register_stlseq_to_numpy_cvt();
+  };
+
+
+  // Converter for STL vector<string> to Python list of str for BOOST
+  struct StlStringVectorToList
   {
-    // Converts STL list<number> to Numpy for boost
-    static PyObject* convert(std::list<T> const& list);
+    // Converts STL vector<string> to list
+    static PyObject* convert(std::vector<std::string> const& seq);
 
+    // Register converter with BOOST unless there is one already
+    static void register_stlstrvec_to_list_cvt();
+  };
+
+
+  // Converter for STL list<ndtypes> to Numpy for BOOST
+  template <typename T> struct StlListToNumpy : StlSeqToNumpy<std::list<T> >
+  {
     // Register STL list<number> to Numpy converter with BOOST
-    static void register_stllist_to_numpy_cvt();
+    static void register_stllist_to_numpy_cvt() { StlSeqToNumpy<std::list<T> >::register_stlseq_to_numpy_cvt(); }
   };
 
 
@@ -22,6 +22,8 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <string>
+#include <boost/make_shared.hpp>
 #include "MsgLogger/MsgLogger.h"
 #include "psana_python/Event.h"
 
@@ -29,9 +31,12 @@
 // Collaborating Class Headers --
 //-------------------------------
 #include "EventIter.h"
+#include "EventPrefetcher.h"
 #include "RunIter.h"
 #include "StepIter.h"
 #include "psana_python/Exceptions.h"
+#include "psana_python/GILReleaser.h"
+#include "psana_python/ObjectLock.h"
 #include "psana_python/Env.h"
 #include "psana_python/PythonModule.h"
 #include "pytools/PyUtil.h"
@@ -46,17 +51,37 @@ namespace {
   PyObject* DataSource_empty(PyObject* self, PyObject*);
   PyObject* DataSource_runs(PyObject* self, PyObject*);
   PyObject* DataSource_steps(PyObject* self, PyObject*);
-  PyObject* DataSource_events(PyObject* self, PyObject*);
+  PyObject* DataSource_events(PyObject* self, PyObject* args, PyObject* kwds);
   PyObject* DataSource_env(PyObject* self, PyObject*);
   PyObject* DataSource_end(PyObject* self, PyObject*);
   PyObject* DataSource_addmodule(PyObject* self, PyObject*);
   PyObject* DataSource_jump(PyObject* self, PyObject*);
 
+  // stop and drop background reader before data source is used directly
+  void stopPrefetch(psana_python::pyext::DataSourceState& state);
+
   PyMethodDef methods[] = {
     { "empty",   DataSource_empty,   METH_NOARGS, "self.empty() -> bool\n\nReturns true if data source has no associated data (\"null\" source)" },
     { "runs",    DataSource_runs,    METH_NOARGS, "self.runs() -> iterator\n\nReturns iterator for contained runs (:py:class:`RunIter`)" },
     { "steps",   DataSource_steps,   METH_NOARGS, "self.steps() -> iterator\n\nReturns iterator for contained steps (:py:class:`StepIter`)" },
-    { "events",  DataSource_events,  METH_NOARGS, "self.events() -> iterator\n\nReturns iterator for contained events  (:py:class:`EventIter`)" },
+    { "events",  (PyCFunction)DataSource_events,  METH_VARARGS | METH_KEYWORDS,
+        "self.events(mode='all', max_lag_ms=100, prefetch=False) -> iterator\n\nReturns iterator for contained events  (:py:class:`EventIter`).\n"
+        "With mode='all' (default) every event is returned. With mode='latest', intended for online monitoring "
+        "and only allowed for live data (shmem=... or exp=...:live), "
+        "events are read by a background thread as soon as they are available and iterator skips "
+        "events which are older than max_lag_ms milliseconds if a newer event was already read, so that "
+        "slow consumer does not drift behind the data; iterator never waits for new data to skip an event. "
+        "Counters of dropped events and achieved latency are available from iterator's stats() method. "
+        "With prefetch=True the next event is read and processed by psana modules in a background thread "
+        "while Python code works on the current event, so that C++ modules overlap with Python analysis; "
+        "note that in this case Python modules in psana module chain may run concurrently with the code of "
+        "the loop. Event which was read ahead is kept by the data source and is returned by the next "
+        "iterator if the loop is interrupted, runs(), steps(), end() and jump() drop it. Environment is "
+        "updated by background thread for the next event, so the first use of its configuration, "
+        "calibration, or EPICS stores or alias map from the loop stops read-ahead, that first use may see "
+        "environment of the next event; prefetch is intended for loops which only read event data. "
+        "In \"latest\" mode read-ahead is restarted for every event, so environment may always belong "
+        "to a newer event." },
     { "env",     DataSource_env,     METH_NOARGS, "self.env() -> object\n\nReturns environment object, cannot be called for \"null\" source" },
     { "end",     DataSource_end,     METH_NOARGS, "self.end() -> for data sources using random access, allows user to specify end-of-job" },
     { "__add_module", DataSource_addmodule, METH_O, "add_module -> allow user to manually add modules"},
@@ -80,6 +105,20 @@ namespace {
 //    -- Public Function Member Definitions --
 //    ----------------------------------------
 
+bool
+psana_python::pyext::DataSourceState::isLive(const std::vector<std::string>& inputs)
+{
+  // live data are read from shared memory or from files being written
+  // ("exp=...:live" option), options are separated by colons
+  for (std::vector<std::string>::const_iterator it = inputs.begin(); it != inputs.end(); ++ it) {
+    const std::string& inp = *it;
+    if (inp.compare(0, 6, "shmem=") == 0) return true;
+    const std::string opts = ":" + inp + ":";
+    if (opts.find(":live:") != std::string::npos) return true;
+  }
+  return false;
+}
+
 void
 psana_python::pyext::DataSource::initType(PyObject* module)
 {
@@ -96,35 +135,90 @@ PyObject*
 DataSource_empty(PyObject* self, PyObject* )
 {
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  return PyBool_FromLong(long(py_this->m_obj.empty()));
+  return PyBool_FromLong(long(py_this->m_obj.ds.empty()));
 }
 
 PyObject*
 DataSource_runs(PyObject* self, PyObject* )
 {
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  return psana_python::pyext::RunIter::PyObject_FromCpp(py_this->m_obj.runs());
+  stopPrefetch(py_this->m_obj);
+  return psana_python::pyext::RunIter::PyObject_FromCpp(py_this->m_obj.ds.runs());
 }
 
 PyObject*
 DataSource_steps(PyObject* self, PyObject* )
 {
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  return psana_python::pyext::StepIter::PyObject_FromCpp(py_this->m_obj.steps());
+  stopPrefetch(py_this->m_obj);
+  return psana_python::pyext::StepIter::PyObject_FromCpp(py_this->m_obj.ds.steps());
 }
 
 PyObject*
-DataSource_events(PyObject* self, PyObject* )
+DataSource_events(PyObject* self, PyObject* args, PyObject* kwds)
 {
+  static char* kwlist[] = {const_cast<char*>("mode"), const_cast<char*>("max_lag_ms"),
+                           const_cast<char*>("prefetch"), 0};
+  const char* mode = "all";
+  double maxLagMs = 100.;
+  PyObject* prefetch = 0;
+  if (not PyArg_ParseTupleAndKeywords(args, kwds, "|sdO:DataSource.events", kwlist, &mode, &maxLagMs, &prefetch)) return 0;
+
+  bool latest = false;
+  if (std::string(mode) == "latest") {
+    latest = true;
+  } else if (std::string(mode) != "all") {
+    PyErr_Format(PyExc_ValueError, "DataSource.events(): unexpected mode '%s', expecting 'all' or 'latest'", mode);
+    return 0;
+  }
+  if (maxLagMs < 0) {
+    PyErr_SetString(PyExc_ValueError, "DataSource.events(): max_lag_ms cannot be negative");
+    return 0;
+  }
+
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  return psana_python::pyext::EventIter::PyObject_FromCpp(py_this->m_obj.events());
+
+  // event age is measured against current time, for offline data all events
+  // are "old" and everything but the last event would be dropped
+  if (latest and not py_this->m_obj.live) {
+    PyErr_SetString(PyExc_ValueError, "DataSource.events(): mode='latest' needs live data source "
+                    "(shmem=... or exp=...:live)");
+    return 0;
+  }
+
+  int doPrefetch = prefetch ? PyObject_IsTrue(prefetch) : 0;
+  if (doPrefetch < 0) return 0;
+
+  // in "latest" mode background thread reads events buffered by live source
+  if (latest) doPrefetch = 1;
+
+  // Prefetcher which finished iteration is not needed any more. Otherwise
+  // it is reused by all following iterators, it may hold event which was
+  // read ahead but not returned, and iterators without prefetch get that
+  // event first and then read through it without read-ahead.
+  boost::shared_ptr<psana_python::pyext::EventPrefetcher>& prefetcher = py_this->m_obj.prefetcher;
+  if (prefetcher and prefetcher->finished()) prefetcher.reset();
+  if (doPrefetch and not prefetcher) {
+    boost::shared_ptr<PSEnv::Env> env = py_this->m_obj.ds.env().shared_from_this();
+    prefetcher = boost::make_shared<psana_python::pyext::EventPrefetcher>(py_this->m_obj.ds.events(), env);
+  }
+  if (prefetcher) prefetcher->setReadAhead(doPrefetch);
+
+  PyObject* iter = psana_python::pyext::EventIter::PyObject_FromCpp(py_this->m_obj.ds.events());
+  if (iter) {
+    psana_python::pyext::EventIterState& state = psana_python::pyext::EventIter::cppObject(iter);
+    state.latest = latest;
+    state.maxLag = maxLagMs * 1e-3;
+    state.prefetcher = prefetcher;
+  }
+  return iter;
 }
 
 PyObject*
 DataSource_env(PyObject* self, PyObject* )
 {
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  PSEnv::Env& env = py_this->m_obj.env();
+  PSEnv::Env& env = py_this->m_obj.ds.env();
   return psana_python::Env::PyObject_FromCpp(env.shared_from_this());
 }
 
@@ -139,11 +233,28 @@ DataSource_end(PyObject* self, PyObject* )
   // module endJob methods to be called.  It is the analog of
   // run.end().  It doesn't hurt to call this in sequential mode, but
   // it isn't necessary.  - cpo
-  py_this->m_obj.events().next();
+  psana_python::ObjectLock lock(self, psana_python::ObjectLock::Iterator);
+  stopPrefetch(py_this->m_obj);
+  {
+    psana_python::GILReleaser releaseGIL;
+    py_this->m_obj.ds.events().next();
+  }
   Py_RETURN_NONE;
 }
 
 
+void
+stopPrefetch(psana_python::pyext::DataSourceState& state)
+{
+  if (not state.prefetcher) return;
+  {
+    // event which was read ahead is dropped
+    psana_python::GILReleaser releaseGIL;
+    state.prefetcher->stopBackground();
+  }
+  state.prefetcher.reset();
+}
+
 PyObject* 
 DataSource_addmodule(PyObject* self, PyObject* obj)
 {
@@ -151,13 +262,14 @@ DataSource_addmodule(PyObject* self, PyObject* obj)
   // will take care of memory management for PYTHON and C++
   MsgLog(pyDSlogger, debug, "Converting incoming PYTHON object (obj) into PSANA Python Module");
   psana_python::PythonModule* pymod = new psana_python::PythonModule("PSANA_PYTHON_MODULE", obj);
+  pymod->addToChain(std::string());
 
   // Cast self as Python DataSouce object
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
 
   // Add obj to list of PSANA's modules
   MsgLog(pyDSlogger, debug, "Adding obj to PSANA's internal list of modules");
-  py_this->m_obj.addmodule(boost::shared_ptr<Module>(pymod));
+  py_this->m_obj.ds.addmodule(boost::shared_ptr<Module>(pymod));
 
   Py_RETURN_NONE;
 }
@@ -237,12 +349,20 @@ DataSource_jump(PyObject* self, PyObject* args)
   }
 
   psana_python::pyext::DataSource* py_this = static_cast<psana_python::pyext::DataSource*>(self);
-  psana::RandomAccess& randomAccess = py_this->m_obj.randomAccess();
-  status = randomAccess.jump(filenames, offsets, lastBeginCalibCycleDgram, runtime, ctx);
-  if (status) Py_RETURN_NONE;
-
-  psana::EventIter evt_iter = py_this->m_obj.events();
-  boost::shared_ptr<PSEvt::Event> evt = evt_iter.next();
+  stopPrefetch(py_this->m_obj);
+  psana::RandomAccess& randomAccess = py_this->m_obj.ds.randomAccess();
+  boost::shared_ptr<PSEvt::Event> evt;
+  {
+    // jump and the following read cannot be interleaved with other threads
+    psana_python::ObjectLock lock(self, psana_python::ObjectLock::Iterator);
+    // both jump and reading of the event do I/O
+    psana_python::GILReleaser releaseGIL;
+    status = randomAccess.jump(filenames, offsets, lastBeginCalibCycleDgram, runtime, ctx);
+    if (not status) {
+      psana::EventIter evt_iter = py_this->m_obj.ds.events();
+      evt = evt_iter.next();
+    }
+  }
   if (evt) {
     return psana_python::Event::PyObject_FromCpp(evt);
   } else {
@@ -13,6 +13,9 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -28,6 +31,12 @@
 //------------------------------------
 #include "psana/DataSource.h"
 
+namespace psana_python {
+namespace pyext {
+class EventPrefetcher;
+}
+}
+
 //    ---------------------
 //    -- Class Interface --
 //    ---------------------
@@ -35,6 +44,27 @@
 namespace psana_python {
 namespace pyext {
 
+/**
+ *  State of the Python data source: psana data source, the flag telling
+ *  whether input is live data (shared memory or ":live" option) which is
+ *  needed by "latest" iteration mode, and background reader which is shared
+ *  by event iterators after events(prefetch=True) was called. Constructor is
+ *  intentionally not explicit so that psana::DataSource can be passed
+ *  directly to DataSource::PyObject_FromCpp().
+ */
+struct DataSourceState {
+
+  DataSourceState(const psana::DataSource& a_ds) : ds(a_ds), live(false) {}
+
+  psana::DataSource ds;    ///< psana data source
+  bool live;               ///< true for live data
+  boost::shared_ptr<EventPrefetcher> prefetcher;  ///< background reader, may be empty
+
+  /// Returns true if any of input specifications describes live data
+  static bool isLive(const std::vector<std::string>& inputs);
+
+};
+
 /**
  *  This software was developed for the LUSI project.  If you use all or
  *  part of it, please give an appropriate acknowledgment.
@@ -44,10 +74,10 @@ namespace pyext {
  *  @author Andrei Salnikov
  */
 
-class DataSource : public pytools::PyDataType<DataSource, psana::DataSource> {
+class DataSource : public pytools::PyDataType<DataSource, DataSourceState> {
 public:
 
-  typedef pytools::PyDataType<DataSource, psana::DataSource> BaseType;
+  typedef pytools::PyDataType<DataSource, DataSourceState> BaseType;
 
   /// Initialize Python type and register it in a module
   static void initType( PyObject* module );
@@ -14,6 +14,7 @@
 // This Class's Header --
 //-----------------------
 #include "EventIter.h"
+#include "EventPrefetcher.h"
 
 //-----------------
 // C/C++ Headers --
@@ -24,7 +25,10 @@
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
+#include "PSEvt/EventId.h"
+#include "psana_python/GILReleaser.h"
 #include "psana_python/Event.h"
+#include "psana_python/ObjectLock.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -35,6 +39,26 @@ namespace {
   // type-specific methods
   PyObject* EventIter_iter(PyObject* self);
   PyObject* EventIter_iternext(PyObject* self);
+  PyObject* EventIter_age(PyObject* self, PyObject*);
+  PyObject* EventIter_stats(PyObject* self, PyObject*);
+
+  // read next event either from prefetcher or directly from psana, needs GIL released
+  boost::shared_ptr<PSEvt::Event> readEvent(psana_python::pyext::EventIterState& state);
+
+  PyMethodDef methods[] = {
+    { "age",     EventIter_age,    METH_NOARGS,
+        "self.age() -> float\n\nReturns the age in seconds of the last event returned by this iterator, "
+        "which is the difference between current time and event time from its EventId. For live data "
+        "this is the latency between data acquisition and analysis. Returns None if no event was "
+        "returned yet or event has no EventId." },
+    { "stats",   EventIter_stats,  METH_NOARGS,
+        "self.stats() -> dict\n\nReturns dictionary with iteration statistics: number of events "
+        "returned (\"delivered\"), number of events skipped in \"latest\" mode (\"dropped\"), and "
+        "the last, mean, and maximum age of returned events at the time they were returned "
+        "(\"latency_last_ms\", \"latency_mean_ms\", \"latency_max_ms\"), events without EventId are "
+        "not included in latency." },
+    {0, 0, 0, 0}
+   };
 
   char typedoc[] = "Class which supports iteration over events contained in a "
       "particular :py:class:`DataSource`, :py:class:`Run`, or :py:class:`Step` "
@@ -54,6 +78,7 @@ psana_python::pyext::EventIter::initType(PyObject* module)
   type->tp_doc = ::typedoc;
   type->tp_iter = EventIter_iter;
   type->tp_iternext = EventIter_iternext;
+  type->tp_methods = ::methods;
 
   BaseType::initType("EventIter", module, "psana");
 }
@@ -67,37 +92,42 @@ EventIter_iter(PyObject* self)
   return self;
 }
 
-/// class for releasing and restoring the the Python GIL lock
-class GILReleaser {
-public:
-  inline GILReleaser()
-  {
-    m_thread_state = PyEval_SaveThread();
-  }
-  
-  inline ~GILReleaser()
-  {
-    PyEval_RestoreThread(m_thread_state);
-    m_thread_state = NULL;
-  }
-
-private:
-  PyThreadState * m_thread_state;
-};
-
 PyObject*
 EventIter_iternext(PyObject* self)
 try {
+  // iterators can be shared between Python threads, lock
+  // stays locked while GIL is released below
+  psana_python::ObjectLock lock(self, psana_python::ObjectLock::Iterator);
   psana_python::pyext::EventIter* py_this = static_cast<psana_python::pyext::EventIter*>(self);
+  psana_python::pyext::EventIterState& state = py_this->m_obj;
+
   boost::shared_ptr<PSEvt::Event> evt;
+  double age = -1;
   {
-    // Release GIL lock during processing of all Psana Modules. 
-    // psana will ensure the GIL is restored/released for Psana Python Modules.
-    // effectively the GIL will be released for only C++ modules.
-    GILReleaser releaseGIL;
-    evt = py_this->m_obj.next();
+    // Release GIL lock during processing of all Psana Modules.
+    // Python modules take it back when they are called, a chain of
+    // consecutive Python modules locks it only once, and if the last
+    // module in the chain is a Python module it stays locked on return.
+    // In "latest" mode stale events are skipped by prefetcher.
+    psana_python::GILReleaser releaseGIL;
+    evt = readEvent(state);
+    if (evt) age = psana_python::pyext::EventPrefetcher::eventAge(*evt, PSTime::Time::now());
   }
   if (evt) {
+    // remember event time to be able to report its age
+    const boost::shared_ptr<PSEvt::EventId>& eventId = evt->get();
+    state.haveLastTime = bool(eventId);
+    if (eventId) state.lastTime = eventId->time();
+
+    // update statistics
+    ++ state.nDelivered;
+    if (age >= 0) {
+      ++ state.nTimed;
+      state.lastLatency = age;
+      state.sumLatency += age;
+      if (age > state.maxLatency) state.maxLatency = age;
+    }
+
     return psana_python::Event::PyObject_FromCpp(evt);
   } else {
     // stop iteration
@@ -109,4 +139,48 @@ try {
   return 0;
 }
 
+PyObject*
+EventIter_age(PyObject* self, PyObject*)
+{
+  psana_python::pyext::EventIter* py_this = static_cast<psana_python::pyext::EventIter*>(self);
+  if (not py_this->m_obj.haveLastTime) Py_RETURN_NONE;
+
+  const PSTime::Time& evtTime = py_this->m_obj.lastTime;
+  const PSTime::Time now = PSTime::Time::now();
+  return PyFloat_FromDouble(double(now.sec()) - double(evtTime.sec()) + (double(now.nsec()) - double(evtTime.nsec())) * 1e-9);
+}
+
+PyObject*
+EventIter_stats(PyObject* self, PyObject*)
+{
+  psana_python::pyext::EventIter* py_this = static_cast<psana_python::pyext::EventIter*>(self);
+  const psana_python::pyext::EventIterState& state = py_this->m_obj;
+
+  double meanLatency = state.nTimed ? state.sumLatency / state.nTimed : 0.;
+  return Py_BuildValue("{s:k,s:k,s:d,s:d,s:d}",
+      "delivered", state.nDelivered,
+      "dropped", state.nDropped,
+      "latency_last_ms", state.lastLatency * 1e3,
+      "latency_mean_ms", meanLatency * 1e3,
+      "latency_max_ms", state.maxLatency * 1e3);
+}
+
+boost::shared_ptr<PSEvt::Event>
+readEvent(psana_python::pyext::EventIterState& state)
+{
+  // GIL may be still locked by Python modules that processed previous event
+  psana_python::GILReleaser::release();
+
+  if (not state.prefetcher) return state.iter.next();
+
+  // "latest" mode needs read-ahead, it is enabled again if environment
+  // was used by the loop since the previous event
+  if (state.latest) state.prefetcher->setReadAhead(true);
+  unsigned long nDropped = 0;
+  boost::shared_ptr<PSEvt::Event> evt = state.prefetcher->next(state.latest ? state.maxLag : -1., nDropped);
+  state.nDropped += nDropped;
+  return evt;
+}
+
+
 }
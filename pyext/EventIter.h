@@ -13,6 +13,8 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <boost/shared_ptr.hpp>
+#include "PSTime/Time.h"
 
 //----------------------
 // Base Class Headers --
@@ -28,6 +30,12 @@
 //------------------------------------
 #include "psana/EventIter.h"
 
+namespace psana_python {
+namespace pyext {
+class EventPrefetcher;
+}
+}
+
 //    ---------------------
 //    -- Class Interface --
 //    ---------------------
@@ -35,6 +43,41 @@
 namespace psana_python {
 namespace pyext {
 
+/**
+ *  State of the Python event iterator. In addition to the psana iterator
+ *  itself it remembers the timestamp of the last event returned to Python
+ *  which is used to report event age for live data, and keeps the options
+ *  and counters of the "latest" iteration mode in which iterator skips
+ *  events which are older than allowed lag. If prefetcher is set then
+ *  events are read through it instead of the psana iterator, "latest"
+ *  mode always uses prefetcher. Constructor is intentionally
+ *  not explicit so that psana::EventIter can be passed directly to
+ *  EventIter::PyObject_FromCpp().
+ */
+struct EventIterState {
+
+  EventIterState(const psana::EventIter& a_iter)
+    : iter(a_iter), lastTime(), haveLastTime(false), latest(false), maxLag(0)
+    , nDelivered(0), nDropped(0), nTimed(0), lastLatency(0), sumLatency(0), maxLatency(0) {}
+
+  psana::EventIter iter;   ///< psana iterator
+  PSTime::Time lastTime;   ///< EventId time of the last returned event
+  bool haveLastTime;       ///< true if lastTime is set
+
+  bool latest;             ///< if true then skip events older than maxLag
+  double maxLag;           ///< maximum allowed event age in seconds for "latest" mode
+
+  boost::shared_ptr<EventPrefetcher> prefetcher;  ///< background reader, may be empty
+
+  unsigned long nDelivered;  ///< number of events returned to Python
+  unsigned long nDropped;    ///< number of events skipped in "latest" mode
+  unsigned long nTimed;      ///< number of returned events which have EventId, used for mean latency
+  double lastLatency;        ///< age of the last returned event at delivery time, seconds
+  double sumLatency;         ///< sum of ages of all returned events, seconds
+  double maxLatency;         ///< maximum age of returned events, seconds
+
+};
+
 /**
  *  This software was developed for the LUSI project.  If you use all or
  *  part of it, please give an appropriate acknowledgment.
@@ -44,10 +87,10 @@ namespace pyext {
  *  @author Andrei Salnikov
  */
 
-class EventIter : public pytools::PyDataType<EventIter, psana::EventIter> {
+class EventIter : public pytools::PyDataType<EventIter, EventIterState> {
 public:
 
-  typedef pytools::PyDataType<EventIter, psana::EventIter> BaseType;
+  typedef pytools::PyDataType<EventIter, EventIterState> BaseType;
 
   /// Initialize Python type and register it in a module
   static void initType( PyObject* module );
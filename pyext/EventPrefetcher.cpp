@@ -0,0 +1,240 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+//  $Id$
+//
+// Description:
+//  Class EventPrefetcher...
+//
+//------------------------------------------------------------------------
+
+// Python header first to suppress warnings
+#include "python/Python.h"
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "EventPrefetcher.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <exception>
+#include <stdexcept>
+#include <boost/bind.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "PSEnv/Env.h"
+#include "PSEvt/Event.h"
+#include "PSEvt/EventId.h"
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+namespace pyext {
+
+//----------------
+// Constructors --
+//----------------
+EventPrefetcher::EventPrefetcher(const psana::EventIter& iter, const boost::shared_ptr<PSEnv::Env>& env)
+  : m_iter(iter)
+  , m_env(env)
+  , m_mutex()
+  , m_cond()
+  , m_readAhead(false)
+  , m_maxLag(-1)
+  , m_requested(false)
+  , m_busy(false)
+  , m_holding(false)
+  , m_ready(false)
+  , m_waiting(0)
+  , m_done(false)
+  , m_stop(false)
+  , m_dropped(0)
+  , m_exception()
+  , m_error()
+  , m_evt()
+  , m_thread(boost::bind(&EventPrefetcher::run, this))
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+EventPrefetcher::~EventPrefetcher()
+{
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_all();
+
+  // worker may be running Python modules and waiting for GIL,
+  // release it while we are waiting for worker to finish
+  PyThreadState* threadState = PyEval_SaveThread();
+  m_thread.join();
+  PyEval_RestoreThread(threadState);
+}
+
+boost::shared_ptr<PSEvt::Event>
+EventPrefetcher::next(double maxLag, unsigned long& nDropped)
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_maxLag = maxLag;
+  nDropped = 0;
+
+  // request event unless it is ready or being read already, several
+  // threads can wait here if iterators are used from different threads
+  ++ m_waiting;
+  while (not m_ready) {
+    if (not m_busy and not m_holding and not m_requested) {
+      if (m_done) {
+        -- m_waiting;
+        return boost::shared_ptr<PSEvt::Event>();
+      }
+      m_requested = true;
+      m_cond.notify_all();
+    }
+    m_cond.wait(lock);
+  }
+  -- m_waiting;
+
+  boost::shared_ptr<PSEvt::Event> evt;
+  m_ready = false;
+  evt.swap(m_evt);
+  nDropped = m_dropped;
+  m_dropped = 0;
+  m_cond.notify_all();
+  if (m_exception) {
+    m_done = true;
+    boost::exception_ptr exception;
+    exception.swap(m_exception);
+    try {
+      boost::rethrow_exception(exception);
+    } catch (const boost::unknown_exception&) {
+      // original type was lost when exception was captured, keep message
+      throw std::runtime_error(m_error);
+    }
+  }
+
+  if (not evt) {
+    m_done = true;
+  } else if (m_readAhead and not m_busy and not m_holding) {
+    // start reading next one while caller is busy with this one
+    m_requested = true;
+  }
+  return evt;
+}
+
+void
+EventPrefetcher::setReadAhead(bool readAhead)
+{
+  // register before read-ahead starts so that environment users can stop it
+  if (readAhead) psana_python::EnvGuard::add(*m_env, shared_from_this());
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_readAhead = readAhead;
+}
+
+void
+EventPrefetcher::stopBackground()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_readAhead = false;
+
+  // read-ahead request which worker did not start yet is cancelled,
+  // but not if some thread is waiting for it in next()
+  if (m_requested and not m_waiting) m_requested = false;
+  while (m_busy or m_requested) m_cond.wait(lock);
+}
+
+bool
+EventPrefetcher::finished()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  return m_done and not m_ready;
+}
+
+double
+EventPrefetcher::eventAge(PSEvt::Event& evt, const PSTime::Time& now)
+{
+  const boost::shared_ptr<PSEvt::EventId>& eventId = evt.get();
+  if (not eventId) return -1;
+  const PSTime::Time& evtTime = eventId->time();
+  return double(now.sec()) - double(evtTime.sec()) + (double(now.nsec()) - double(evtTime.nsec())) * 1e-9;
+}
+
+// main method of worker thread
+void
+EventPrefetcher::run()
+{
+  // Python modules in the chain may use environment
+  psana_python::EnvGuard::setBackground();
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  while (true) {
+    while (not m_requested and not m_stop) m_cond.wait(lock);
+    if (m_stop) break;
+    m_requested = false;
+    m_busy = true;
+
+    // do not hold the lock while modules run
+    lock.unlock();
+    boost::shared_ptr<PSEvt::Event> evt;
+    boost::exception_ptr exception;
+    std::string error;
+    try {
+      evt = m_iter.next();
+    } catch (const std::exception& ex) {
+      exception = boost::current_exception();
+      error = ex.what();
+    } catch (...) {
+      exception = boost::current_exception();
+      error = "unknown exception while reading next event";
+    }
+    lock.lock();
+    m_busy = false;
+    m_holding = true;
+
+    // Previous event was not taken yet, this happens in "latest" mode.
+    // It is replaced by the new one once it gets older than allowed lag,
+    // so the newest event read so far is never dropped.
+    while (m_ready and not m_stop) {
+      double wait = -1;
+      if (m_maxLag >= 0 and m_evt and not m_exception) {
+        const double age = eventAge(*m_evt, PSTime::Time::now());
+        if (age >= 0) {
+          wait = m_maxLag - age;
+          if (wait <= 0) {
+            m_evt.reset();
+            m_ready = false;
+            ++ m_dropped;
+            break;
+          }
+        }
+      }
+      if (wait > 0) {
+        m_cond.timed_wait(lock, boost::posix_time::microseconds(long(wait * 1e6) + 1));
+      } else {
+        m_cond.wait(lock);
+      }
+    }
+    m_holding = false;
+    if (m_stop) break;
+
+    m_evt = evt;
+    m_exception = exception;
+    m_error = error;
+    m_ready = true;
+
+    // in "latest" mode worker keeps reading so that consumer gets the newest event
+    if (m_maxLag >= 0 and m_readAhead and evt) m_requested = true;
+    m_cond.notify_all();
+  }
+}
+
+} // namespace pyext
+} // namespace psana_python
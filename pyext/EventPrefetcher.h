@@ -0,0 +1,160 @@
+#ifndef PSANA_PYTHON_PYEXT_EVENTPREFETCHER_H
+#define PSANA_PYTHON_PYEXT_EVENTPREFETCHER_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class EventPrefetcher.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <boost/exception_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/utility.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "psana_python/EnvGuard.h"
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psana/EventIter.h"
+#include "PSTime/Time.h"
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+namespace PSEnv {
+class Env;
+}
+namespace PSEvt {
+class Event;
+}
+
+//    ---------------------
+//    -- Class Interface --
+//    ---------------------
+
+namespace psana_python {
+namespace pyext {
+
+/**
+ *  @brief Two-stage pipeline for event iteration.
+ *
+ *  Instance of this class owns a worker thread which calls psana::EventIter::next()
+ *  for the next event while Python code is still processing current event.
+ *  This way C++ modules (calibration, image assembly, etc.) for event N+1 run
+ *  concurrently with Python analysis of event N. The queue between stages is
+ *  bounded to a single event. One instance is shared by all event iterators
+ *  of a data source so that event which was read ahead is not lost when
+ *  iteration is interrupted and resumed with another iterator.
+ *
+ *  While worker runs modules for event N+1 it also updates environment
+ *  (configuration, calibration and EPICS stores, alias map). Prefetcher is
+ *  registered as EnvGuard client, when Python code outside of module chain
+ *  uses environment the read-ahead is stopped and after that worker reads
+ *  next event only when it is requested. Environment seen at that first use
+ *  may already belong to the event which was read ahead.
+ *
+ *  In "latest" mode worker reads continuously so that events buffered by
+ *  live source are consumed even if Python code is slow, stale events are
+ *  only dropped when a newer one was already read.
+ *
+ *  Methods of this class must be called with the Python GIL released, worker
+ *  thread may need GIL to run Python modules in psana module chain. Destructor
+ *  releases GIL itself while waiting for worker thread to finish, so it must
+ *  be called while GIL is held (which is the case for Python object dealloc).
+ *
+ *  This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @version $Id$
+ */
+
+class EventPrefetcher : public psana_python::EnvGuard::Client
+                      , public boost::enable_shared_from_this<EventPrefetcher>
+                      , boost::noncopyable {
+public:
+
+  /**
+   *  Constructor takes iterator which will be used by worker thread and its
+   *  environment, read-ahead is disabled initially. Instance must be owned
+   *  by boost::shared_ptr.
+   */
+  EventPrefetcher(const psana::EventIter& iter, const boost::shared_ptr<PSEnv::Env>& env);
+
+  /// Destructor stops worker thread, must be called with GIL held
+  virtual ~EventPrefetcher();
+
+  /**
+   *  Return next event, waiting for worker thread if it is not ready yet,
+   *  and start reading one more event in background if read-ahead is
+   *  enabled. Returns zero pointer at the end of data. Exceptions from
+   *  worker thread are re-thrown in the calling thread, exceptions which
+   *  cannot be cloned (not derived from boost::exception or standard
+   *  exception types) are re-thrown as std::runtime_error with the same
+   *  message.
+   *
+   *  Non-negative maxLag selects "latest" mode: with read-ahead enabled the
+   *  worker keeps reading events and replaces event which was not taken yet
+   *  by a newer one when it gets older than maxLag seconds. Number of events
+   *  replaced before returned event is stored in nDropped.
+   */
+  boost::shared_ptr<PSEvt::Event> next(double maxLag, unsigned long& nDropped);
+
+  /// Enable or disable reading in background, enabling registers instance with EnvGuard
+  void setReadAhead(bool readAhead);
+
+  /// Wait until worker is idle and disable read-ahead, event already read stays pending
+  virtual void stopBackground();
+
+  /// Returns true if end of data or error was returned by next()
+  bool finished();
+
+  /// Returns age of the event in seconds or negative number if event has no time
+  static double eventAge(PSEvt::Event& evt, const PSTime::Time& now);
+
+protected:
+
+  // main method of worker thread
+  void run();
+
+private:
+
+  psana::EventIter m_iter;
+  boost::shared_ptr<PSEnv::Env> m_env;
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  bool m_readAhead;     // request next event after returning current one
+  double m_maxLag;      // allowed lag in seconds for "latest" mode, negative otherwise
+  bool m_requested;     // worker should read one more event
+  bool m_busy;          // worker is reading event
+  bool m_holding;       // worker has read event and waits until previous one is taken
+  bool m_ready;         // worker finished reading and result is available
+  unsigned m_waiting;   // number of threads waiting in next()
+  bool m_done;          // end of data seen or error happened
+  bool m_stop;          // worker should exit
+  unsigned long m_dropped;  // events replaced since the last one was taken
+  boost::exception_ptr m_exception;  // exception from worker, if any
+  std::string m_error;  // and its message
+  boost::shared_ptr<PSEvt::Event> m_evt;
+  boost::thread m_thread;
+
+};
+
+} // namespace pyext
+} // namespace psana_python
+
+#endif // PSANA_PYTHON_PYEXT_EVENTPREFETCHER_H
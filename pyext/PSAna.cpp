@@ -22,11 +22,13 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <boost/thread/mutex.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
 #include "DataSource.h"
+#include "psana_python/GILReleaser.h"
 #include "pytools/PyUtil.h"
 
 //-----------------------------------------------------------------------
@@ -41,6 +43,12 @@ namespace {
   typedef int PyDictPosType;
 #endif
 
+  // psana keeps current framework context and configuration in global state
+  // while framework instance and its data sources are set up, this lock
+  // serializes that setup when several threads create data sources at the
+  // same time. Never wait for it while holding GIL, module loading needs GIL.
+  boost::mutex setupMutex;
+
   // type-specific methods
   PyObject* PSAna_new(PyTypeObject *subtype, PyObject *args, PyObject *kwds);
   PyObject* PSAna_dataSource(PyObject* self, PyObject* args);
@@ -129,6 +137,8 @@ PSAna_new(PyTypeObject *subtype, PyObject *args, PyObject *kwds)
 
   // instantiate framework
   try {
+    psana_python::GILReleaser releaseGIL;
+    boost::mutex::scoped_lock lock(setupMutex);
     py_this->m_obj = boost::make_shared<psana::PSAna>(std::string(config), optMap);
   } catch (const std::exception& ex) {
     subtype->tp_dealloc(self);
@@ -183,7 +193,17 @@ try {
     }
   }
     
-  return psana_python::pyext::DataSource::PyObject_FromCpp(py_this->m_obj->dataSource(inpVec));
+  // this opens input files and loads all modules, Python modules lock GIL
+  // themselves when they are imported
+  psana::DataSource ds;
+  {
+    psana_python::GILReleaser releaseGIL;
+    boost::mutex::scoped_lock lock(setupMutex);
+    ds = py_this->m_obj->dataSource(inpVec);
+  }
+  PyObject* pyds = psana_python::pyext::DataSource::PyObject_FromCpp(ds);
+  if (pyds) psana_python::pyext::DataSource::cppObject(pyds).live = psana_python::pyext::DataSourceState::isLive(inpVec);
+  return pyds;
 
 } catch (const std::exception& ex) {
   PyErr_SetString(PyExc_RuntimeError, ex.what());
@@ -34,6 +34,7 @@
 #include "EventIter.h"
 #include "StepIter.h"
 #include "psana_python/Env.h"
+#include "psana_python/GILReleaser.h"
 #include "EventTime.h"
 #include "psana/Index.h"
 
@@ -111,11 +112,14 @@ Run_end(PyObject* self, PyObject* )
 {
   // tell the index object to give us the EndRun datagram
   psana_python::pyext::Run* py_this = static_cast<psana_python::pyext::Run*>(self);
-  py_this->m_obj.index().end();
-  
-  // use the event iterator to fetch the endrun and send it to the modules
-  psana::EventIter evt_iter = py_this->m_obj.events();
-  boost::shared_ptr<PSEvt::Event> evt = evt_iter.next();
+  {
+    psana_python::GILReleaser releaseGIL;
+    py_this->m_obj.index().end();
+
+    // use the event iterator to fetch the endrun and send it to the modules
+    psana::EventIter evt_iter = py_this->m_obj.events();
+    boost::shared_ptr<PSEvt::Event> evt = evt_iter.next();
+  }
   Py_RETURN_NONE;
 }
 
@@ -162,10 +166,14 @@ Run_times(PyObject* self, PyObject* args)
   psana::Index::EventTimeIter begin;
   psana::Index::EventTimeIter end;
 
-  if (getsteptimes)
-    py_this->m_obj.index().times(nstep,begin,end);
-  else
-    py_this->m_obj.index().times(begin,end);
+  {
+    // this may need to read the index files
+    psana_python::GILReleaser releaseGIL;
+    if (getsteptimes)
+      py_this->m_obj.index().times(nstep,begin,end);
+    else
+      py_this->m_obj.index().times(begin,end);
+  }
 
   // the old way that worked when we used NPY_COMPLEX128 numpy arrays
   // npy_intp length=idxtimes.size();
@@ -195,11 +203,17 @@ Run_event(PyObject* self, PyObject* args)
 
   psana_python::pyext::Run* py_this = static_cast<psana_python::pyext::Run*>(self);
   psana::Index& index = py_this->m_obj.index();
-  status = index.jump(pyEventTime->m_obj);
-  if (status) Py_RETURN_NONE;
-
-  psana::EventIter evt_iter = py_this->m_obj.events();
-  boost::shared_ptr<PSEvt::Event> evt = evt_iter.next();
+  const psana::EventTime time = pyEventTime->m_obj;
+  boost::shared_ptr<PSEvt::Event> evt;
+  {
+    // both jump and reading of the event do I/O
+    psana_python::GILReleaser releaseGIL;
+    status = index.jump(time);
+    if (not status) {
+      psana::EventIter evt_iter = py_this->m_obj.events();
+      evt = evt_iter.next();
+    }
+  }
   if (evt) {
     return psana_python::Event::PyObject_FromCpp(evt);
   } else {
@@ -24,6 +24,8 @@
 // Collaborating Class Headers --
 //-------------------------------
 #include "Run.h"
+#include "psana_python/GILReleaser.h"
+#include "psana_python/ObjectLock.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -68,8 +70,15 @@ RunIter_iter(PyObject* self)
 PyObject*
 RunIter_iternext(PyObject* self)
 try {
+  // iterators can be shared between Python threads, GIL is released below
+  psana_python::ObjectLock lock(self, psana_python::ObjectLock::Iterator);
   psana_python::pyext::RunIter* py_this = static_cast<psana_python::pyext::RunIter*>(self);
-  psana::Run run = py_this->m_obj.next();
+  psana::Run run;
+  {
+    // moving to next run reads data and calls modules
+    psana_python::GILReleaser releaseGIL;
+    run = py_this->m_obj.next();
+  }
   if (run) {
     return psana_python::pyext::Run::PyObject_FromCpp(run);
   } else {
@@ -24,6 +24,8 @@
 // Collaborating Class Headers --
 //-------------------------------
 #include "Step.h"
+#include "psana_python/GILReleaser.h"
+#include "psana_python/ObjectLock.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -68,8 +70,15 @@ StepIter_iter(PyObject* self)
 PyObject*
 StepIter_iternext(PyObject* self)
 try {
+  // iterators can be shared between Python threads, GIL is released below
+  psana_python::ObjectLock lock(self, psana_python::ObjectLock::Iterator);
   psana_python::pyext::StepIter* py_this = static_cast<psana_python::pyext::StepIter*>(self);
-  psana::Step step = py_this->m_obj.next();
+  psana::Step step;
+  {
+    // moving to next step reads data and calls modules
+    psana_python::GILReleaser releaseGIL;
+    step = py_this->m_obj.next();
+  }
   if (step) {
     return psana_python::pyext::Step::PyObject_FromCpp(step);
   } else {
@@ -30,6 +30,9 @@
 #include "Step.h"
 #include "StepIter.h"
 #include "EventTime.h"
+#include "psana_python/ArrayPool.h"
+#include "psana_python/ConverterStats.h"
+#include "psana_python/StartupTrace.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -65,6 +68,38 @@ namespace psana_python {
 
 }
 
+namespace {
+
+  PyObject* startupTrace(PyObject* self, PyObject*);
+  PyObject* converterStats(PyObject* self, PyObject* args);
+  PyObject* arrayPool(PyObject* self, PyObject* args);
+
+  PyMethodDef methods[] = {
+    { "startupTrace", startupTrace, METH_NOARGS,
+        "startupTrace() -> list of tuples\n\n"
+        "Returns timing of job startup phases (initialization of this module, import and "
+        "instantiation of user modules) as a list of (phase:str, start:float, duration:float) "
+        "tuples, times are in seconds, start time is counted from loading of this module. Only the "
+        "first 1000 phases are recorded." },
+    { "converterStats", converterStats, METH_VARARGS,
+        "converterStats(reset=False) -> dict\n\n"
+        "Returns counters of array conversions between C++ and Python: \"to_numpy\" and \"from_numpy\" "
+        "map (type, rank) to number of conversions, \"zero_copy_bytes\" is the size of data shared "
+        "without copying, \"copied_bytes\" the size of data copied from STL containers, "
+        "\"contiguous_copies\" and \"contiguous_bytes\" count C-ordered copies of strided ndarrays, and "
+        "\"rejected\" counts rejected conversions by reason. If reset is true counters are "
+        "set to zero after reading." },
+    { "arrayPool", arrayPool, METH_VARARGS,
+        "arrayPool(hugepages=-1, cache_limit=-1) -> dict\n\n"
+        "Configures pool of memory blocks used by Event.empty() and returns its state. If hugepages "
+        "is 0 or 1 huge pages are disabled or enabled for blocks of 2MB and larger, if cache_limit "
+        "is not negative it sets limit (in bytes) on the total size of free blocks kept for reuse. "
+        "Negative values leave settings unchanged." },
+    {0, 0, 0, 0}
+  };
+
+}
+
 //		----------------------------------------
 // 		-- Public Function Member Definitions --
 //		----------------------------------------
@@ -77,8 +112,22 @@ PyMODINIT_FUNC PyInit__psana()
 PyMODINIT_FUNC init_psana()
 #endif
 {
+#if PY_VERSION_HEX >= 0x03090000
+  // Extension types are static and shared by all interpreters, boost.python
+  // and converter registries are process-global, and psana framework state
+  // lives in global context. None of this can be duplicated per interpreter,
+  // so refuse loading into sub-interpreters instead of sharing objects across
+  // interpreters with independent (or separate) GILs.
+  if (PyInterpreterState_Get() != PyInterpreterState_Main()) {
+    PyErr_SetString(PyExc_ImportError, "_psana module can only be imported in the main interpreter");
+    return 0;
+  }
+#endif
+
+  psana_python::StartupTrace trace("_psana import");
+
   // Initialize the module
-  DDL_CREATE_MODULE( "_psana", 0, "The Python module for psana" );
+  DDL_CREATE_MODULE( "_psana", ::methods, "The Python module for psana" );
   psana_python::pyext::DataSource::initType( module );
   psana_python::pyext::EventIter::initType( module );
   psana_python::pyext::PSAna::initType( module );
@@ -90,8 +139,56 @@ PyMODINIT_FUNC init_psana()
 
   psana_python::createWrappers(module);
 
+  // Module does not declare Py_MOD_GIL_NOT_USED, free-threaded Python keeps
+  // GIL enabled when it is imported. ObjectLock protects iterators, events
+  // and converter registries, generated psddl wrappers were not audited yet.
+
 #ifdef IS_PY3K
   return module;
 #endif
 }
 
+namespace {
+
+PyObject*
+startupTrace(PyObject* self, PyObject*)
+{
+  const std::vector<psana_python::StartupTrace::Entry>& entries = psana_python::StartupTrace::entries();
+  PyObject* list = PyList_New(entries.size());
+  if (not list) return 0;
+  for (unsigned i = 0; i != entries.size(); ++ i) {
+    const psana_python::StartupTrace::Entry& entry = entries[i];
+    PyObject* item = Py_BuildValue("(sdd)", entry.phase.c_str(), entry.start, entry.duration);
+    if (not item) {
+      Py_DECREF(list);
+      return 0;
+    }
+    PyList_SET_ITEM(list, i, item);
+  }
+  return list;
+}
+
+PyObject*
+converterStats(PyObject* self, PyObject* args)
+{
+  int reset = 0;
+  if (not PyArg_ParseTuple(args, "|i:converterStats", &reset)) return 0;
+
+  PyObject* stats = psana_python::ConverterStats::asDict();
+  if (reset) psana_python::ConverterStats::reset();
+  return stats;
+}
+
+PyObject*
+arrayPool(PyObject* self, PyObject* args)
+{
+  int hugepages = -1;
+  Py_ssize_t cacheLimit = -1;
+  if (not PyArg_ParseTuple(args, "|in:arrayPool", &hugepages, &cacheLimit)) return 0;
+
+  if (hugepages >= 0) psana_python::ArrayPool::setHugePages(hugepages);
+  if (cacheLimit >= 0) psana_python::ArrayPool::setCacheLimit(cacheLimit);
+  return psana_python::ArrayPool::asDict();
+}
+
+}
@@ -31,6 +31,7 @@
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
+#include "psana_python/EnvGuard.h"
 #include "psana_python/PdsSrc.h"
 #include "pytools/make_pyshared.h"
 
@@ -118,6 +119,7 @@ PyObject*
 AliasMap_clear(PyObject* self, PyObject*)
 {
   boost::shared_ptr<PSEvt::AliasMap>& cself = AliasMap::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
   cself->clear();
   Py_RETURN_NONE;
 }
@@ -126,6 +128,7 @@ PyObject*
 AliasMap_add(PyObject* self, PyObject* args)
 {
   boost::shared_ptr<PSEvt::AliasMap>& cself = psana_python::AliasMap::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* alias;
   PyObject* srcObj;
@@ -144,6 +147,7 @@ PyObject*
 AliasMap_src(PyObject* self, PyObject* args)
 {
   boost::shared_ptr<PSEvt::AliasMap>& cself = psana_python::AliasMap::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* alias;
   if (not PyArg_ParseTuple( args, "s:AliasMap.src", &alias)) return 0;
@@ -155,6 +159,7 @@ PyObject*
 AliasMap_alias(PyObject* self, PyObject* args)
 {
   boost::shared_ptr<PSEvt::AliasMap>& cself = psana_python::AliasMap::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   PyObject* srcObj;
   if (not PyArg_ParseTuple( args, "O:AliasMap.add", &srcObj)) return 0;
@@ -175,6 +180,7 @@ PyObject*
 AliasMap_srcs(PyObject* self, PyObject* args)
 {
   boost::shared_ptr<PSEvt::AliasMap>& cself = psana_python::AliasMap::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const std::vector<Pds::Src>& srcs = cself->srcs();
   
@@ -0,0 +1,256 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Functions which post-process arrays returned from get() methods.
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ArrayConvert.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <stdint.h>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psana_python/ConverterStats.h"
+#include "psana_python/GILReleaser.h"
+#include "psddl_python/psddl_python_numpy.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  /*
+   *  Conversion kernel, destination is C-contiguous, source strides are in
+   *  bytes. Innermost contiguous loop is simple enough for compiler to
+   *  vectorize. Returns pointer past last written element.
+   */
+  template <typename Src, typename Dst>
+  Dst* convertLoop(const char* src, Dst* dst, int rank, const npy_intp* shape, const npy_intp* strides)
+  {
+    if (rank == 0) {
+      *dst = Dst(*reinterpret_cast<const Src*>(src));
+      return dst + 1;
+    }
+
+    const npy_intp n = shape[0];
+    const npy_intp stride = strides[0];
+    if (rank > 1) {
+      for (npy_intp i = 0; i != n; ++ i, src += stride) {
+        dst = convertLoop<Src, Dst>(src, dst, rank-1, shape+1, strides+1);
+      }
+    } else if (stride == npy_intp(sizeof(Src))) {
+      const Src* s = reinterpret_cast<const Src*>(src);
+      for (npy_intp i = 0; i != n; ++ i) dst[i] = Dst(s[i]);
+      dst += n;
+    } else {
+      for (npy_intp i = 0; i != n; ++ i, src += stride) *dst++ = Dst(*reinterpret_cast<const Src*>(src));
+    }
+    return dst;
+  }
+
+  template <typename Src, typename Dst>
+  void convertArray(PyObject* src, PyObject* dst)
+  {
+    const char* data = PyArray_BYTES(src);
+    Dst* out = reinterpret_cast<Dst*>(PyArray_DATA(dst));
+    if (PyArray_SIZE(src) == 0) return;
+
+    // GIL is not needed, both arrays are referenced by caller
+    psana_python::GILReleaser releaser;
+    if (PyArray_ISCARRAY_RO(src)) {
+      npy_intp size = PyArray_SIZE(src);
+      npy_intp stride = sizeof(Src);
+      convertLoop<Src, Dst>(data, out, 1, &size, &stride);
+    } else {
+      convertLoop<Src, Dst>(data, out, PyArray_NDIM(src), PyArray_DIMS(src), PyArray_STRIDES(src));
+    }
+  }
+
+  template <typename Dst>
+  bool convertFrom(PyObject* src, PyObject* dst)
+  {
+    switch (PyArray_TYPE(src)) {
+    case NPY_INT8: convertArray<int8_t, Dst>(src, dst); return true;
+    case NPY_UINT8: convertArray<uint8_t, Dst>(src, dst); return true;
+    case NPY_INT16: convertArray<int16_t, Dst>(src, dst); return true;
+    case NPY_UINT16: convertArray<uint16_t, Dst>(src, dst); return true;
+    case NPY_INT32: convertArray<int32_t, Dst>(src, dst); return true;
+    case NPY_UINT32: convertArray<uint32_t, Dst>(src, dst); return true;
+    case NPY_INT64: convertArray<int64_t, Dst>(src, dst); return true;
+    case NPY_UINT64: convertArray<uint64_t, Dst>(src, dst); return true;
+    case NPY_FLOAT32: convertArray<float, Dst>(src, dst); return true;
+    case NPY_FLOAT64: convertArray<double, Dst>(src, dst); return true;
+    default: return false;
+    }
+  }
+
+  // Range of memory addresses used by array data, [begin, end)
+  void memoryExtent(PyObject* array, const char*& begin, const char*& end)
+  {
+    begin = end = PyArray_BYTES(array);
+    if (PyArray_SIZE(array) == 0) return;
+    for (int i = 0; i != PyArray_NDIM(array); ++ i) {
+      const npy_intp offset = (PyArray_DIM(array, i) - 1) * PyArray_STRIDE(array, i);
+      if (offset < 0) {
+        begin += offset;
+      } else {
+        end += offset;
+      }
+    }
+    end += PyArray_ITEMSIZE(array);
+  }
+
+  // Returns true if data of two arrays may share memory, only compares the
+  // ranges so it can give false positive for interleaved arrays
+  bool mayShareMemory(PyObject* lhs, PyObject* rhs)
+  {
+    const char *lbegin, *lend, *rbegin, *rend;
+    memoryExtent(lhs, lbegin, lend);
+    memoryExtent(rhs, rbegin, rend);
+    return lbegin < rend and rbegin < lend;
+  }
+
+  /*
+   *  Copy data between arrays of the same shape converting element type,
+   *  our own kernels are used for supported numeric types with aligned data
+   *  in native byte order and C-contiguous destination which does not
+   *  overlap source, everything else goes to numpy which handles overlap.
+   *  Floating point to integer conversion also goes to numpy, in C++ it is
+   *  undefined for NaN and values out of range and numpy defines it.
+   *  Returns negative number on error.
+   */
+  int copyArray(PyObject* dst, PyObject* src)
+  {
+    if (PyArray_ISCARRAY(dst) and PyArray_ISNOTSWAPPED(dst) and
+        PyArray_ISALIGNED(src) and PyArray_ISNOTSWAPPED(src) and
+        not (PyArray_ISFLOAT(src) and PyArray_ISINTEGER(dst)) and
+        not mayShareMemory(dst, src)) {
+      bool done = false;
+      switch (PyArray_TYPE(dst)) {
+      case NPY_INT8: done = convertFrom<int8_t>(src, dst); break;
+      case NPY_UINT8: done = convertFrom<uint8_t>(src, dst); break;
+      case NPY_INT16: done = convertFrom<int16_t>(src, dst); break;
+      case NPY_UINT16: done = convertFrom<uint16_t>(src, dst); break;
+      case NPY_INT32: done = convertFrom<int32_t>(src, dst); break;
+      case NPY_UINT32: done = convertFrom<uint32_t>(src, dst); break;
+      case NPY_INT64: done = convertFrom<int64_t>(src, dst); break;
+      case NPY_UINT64: done = convertFrom<uint64_t>(src, dst); break;
+      case NPY_FLOAT32: done = convertFrom<float>(src, dst); break;
+      case NPY_FLOAT64: done = convertFrom<double>(src, dst); break;
+      }
+      if (done) return 0;
+    }
+
+    // numpy releases GIL itself for copies of non-object types
+    return PyArray_CopyInto((PyArrayObject*)dst, (PyArrayObject*)src);
+  }
+
+  // Copy array into out= argument, steals reference to result
+  PyObject* copyToOut(PyObject* result, PyObject* out)
+  {
+    if (not PyArray_Check(out) or not PyArray_ISWRITEABLE(out)) {
+      Py_DECREF(result);
+      PyErr_SetString(PyExc_TypeError, "get(..., out=): out must be a writeable numpy array");
+      return 0;
+    }
+    if (result == out) return result;
+
+    // shapes must be identical, no broadcasting
+    bool sameShape = PyArray_NDIM(result) == PyArray_NDIM(out);
+    for (int i = 0; sameShape and i != PyArray_NDIM(out); ++ i) {
+      sameShape = PyArray_DIM(result, i) == PyArray_DIM(out, i);
+    }
+    if (not sameShape) {
+      Py_DECREF(result);
+      PyErr_SetString(PyExc_ValueError, "get(..., out=): out array has different shape");
+      return 0;
+    }
+
+    int stat = ::copyArray(out, result);
+    Py_DECREF(result);
+    if (stat < 0) return 0;
+
+    psana_python::ConverterStats::countCopy(PyArray_NBYTES(out));
+
+    Py_INCREF(out);
+    return out;
+  }
+
+  // Convert array to new array of given type, steals references to result and descr
+  PyObject* convertToType(PyObject* result, PyArray_Descr* descr)
+  {
+    // same type means no conversion, data stay shared with C++
+    if (PyArray_EquivTypes(descr, PyArray_DESCR(result))) {
+      Py_DECREF(descr);
+      return result;
+    }
+
+    PyObject* array = PyArray_NewFromDescr(&PyArray_Type, descr, PyArray_NDIM(result), PyArray_DIMS(result),
+                                           0, 0, 0, 0);
+    if (not array) {
+      Py_DECREF(result);
+      return 0;
+    }
+    PyObject* res = ::copyToOut(result, array);
+    Py_DECREF(array);
+    return res;
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+PyObject*
+applyGetOptions(PyObject* result, PyObject* dtype, PyObject* out)
+{
+  if (not result or result == Py_None) return result;
+
+  if (out == Py_None) out = 0;
+  if (dtype == Py_None) dtype = 0;
+  if (not out and not dtype) return result;
+
+  if (not PyArray_Check(result)) {
+    PyErr_Format(PyExc_TypeError, "get(..., %s=): object of type %s is not an array",
+                 out ? "out" : "dtype", result->ob_type->tp_name);
+    Py_DECREF(result);
+    return 0;
+  }
+
+  PyArray_Descr* descr = 0;
+  if (dtype and not PyArray_DescrConverter(dtype, &descr)) {
+    Py_DECREF(result);
+    return 0;
+  }
+
+  if (out) {
+    if (descr) {
+      bool same = PyArray_Check(out) and PyArray_EquivTypes(descr, PyArray_DESCR(out));
+      Py_DECREF(descr);
+      if (not same) {
+        Py_DECREF(result);
+        PyErr_SetString(PyExc_TypeError, "get(..., dtype=, out=): out array must have requested dtype");
+        return 0;
+      }
+    }
+    return ::copyToOut(result, out);
+  }
+
+  return ::convertToType(result, descr);
+}
+
+} // namespace psana_python
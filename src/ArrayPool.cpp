@@ -0,0 +1,406 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ArrayPool...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ArrayPool.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <map>
+#include <new>
+#include <vector>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/weak_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psddl_python/psddl_python_numpy.h"
+#include "PSEvt/ProxyDictI.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  const size_t PageSize = 4096;
+  const size_t HugePageSize = 2*1024*1024;
+
+  // Sequence of events which use the pool one after another. Cached blocks
+  // are only trimmed by ends of events of the stream which released them so
+  // that concurrent event loops do not free blocks needed by each other.
+  // Events which get their first array in the same thread share a stream.
+  struct Stream {
+    Stream() : epoch(0) {}
+    unsigned long epoch;  // number of ended events, protected by g_mutex
+  };
+
+  // free block, stream which released it and the number of events ended
+  // in that stream and in all streams before it was released
+  struct FreeBlock {
+    void* ptr;
+    boost::weak_ptr<Stream> stream;
+    unsigned long epoch;
+    unsigned long globalEpoch;
+  };
+
+  // blocks are released from any thread
+  boost::mutex g_mutex;
+  typedef std::map<size_t, std::vector<FreeBlock> > FreeLists;
+  FreeLists g_free;
+  size_t g_cachedBytes = 0;
+  size_t g_cacheLimit = 512*1024*1024;
+  bool g_hugePages = false;
+  unsigned long g_allocated = 0;
+  unsigned long g_reused = 0;
+  unsigned long g_epoch = 0;
+
+  const char capsuleName[] = "psana.ArrayPool";
+
+  // stream of events made in this thread
+  boost::thread_specific_ptr<boost::shared_ptr<Stream> > t_stream;
+
+  const boost::shared_ptr<Stream>& threadStream()
+  {
+    if (not t_stream.get()) t_stream.reset(new boost::shared_ptr<Stream>(boost::make_shared<Stream>()));
+    return *t_stream;
+  }
+
+  // Return block to free list, stream may be empty for blocks not given to events
+  void release(void* ptr, size_t size, const boost::shared_ptr<Stream>& stream);
+
+  // Frees cached blocks of the stream which were not reused during the event
+  void endEvent(const boost::shared_ptr<Stream>& stream);
+
+  // Made by numpyEmpty() for every event, all blocks given to this event
+  // keep it alive so it is destroyed after event and all its arrays are gone
+  class Arena {
+  public:
+    explicit Arena(const boost::shared_ptr<Stream>& stream) : m_stream(stream) {}
+    ~Arena() { ::endEvent(m_stream); }
+    const boost::shared_ptr<Stream>& stream() const { return m_stream; }
+  private:
+    boost::shared_ptr<Stream> m_stream;
+  };
+
+  // Block given to numpy array, owned by capsule
+  struct Block {
+    void* data;
+    size_t size;
+    boost::shared_ptr<Arena> arena;
+  };
+
+  // Arenas of live events. Event itself holds no reference to its arena,
+  // arena is dropped from this table when event is gone, lock is separate
+  // from g_mutex because destroying arena calls endEvent().
+  struct ArenaRef {
+    boost::weak_ptr<PSEvt::ProxyDictI> dict;
+    boost::shared_ptr<Arena> arena;
+  };
+  typedef std::map<const PSEvt::ProxyDictI*, ArenaRef> Arenas;
+  boost::mutex g_arenaMutex;
+  Arenas g_arenas;
+
+  // Round size up so that arrays of similar size share free list, page
+  // granularity for anything larger than a page
+  size_t blockSize(size_t size)
+  {
+    const size_t align = size > PageSize ? PageSize : size_t(psana_python::ArrayPool::Alignment);
+    if (size == 0) size = 1;
+    return (size + align - 1) / align * align;
+  }
+
+  // Capsule destructor, numpy array base owns pool block
+  void releaseCapsule(PyObject* capsule)
+  {
+    Block* block = static_cast<Block*>(PyCapsule_GetPointer(capsule, capsuleName));
+    ::release(block->data, block->size, block->arena->stream());
+    delete block;
+  }
+
+  // Move arenas of destroyed events to a list, arenas are destroyed when
+  // the list is gone and table is not locked any more
+  void sweepArenas(std::vector<boost::shared_ptr<Arena> >& ended)
+  {
+    for (Arenas::iterator it = g_arenas.begin(); it != g_arenas.end(); ) {
+      if (it->second.dict.expired()) {
+        ended.push_back(it->second.arena);
+        g_arenas.erase(it ++);
+      } else {
+        ++ it;
+      }
+    }
+  }
+
+  // Find arena of the event or make new one
+  boost::shared_ptr<Arena> eventArena(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict)
+  {
+    std::vector<boost::shared_ptr<Arena> > ended;
+    boost::mutex::scoped_lock lock(g_arenaMutex);
+    sweepArenas(ended);
+    ArenaRef& ref = g_arenas[proxyDict.get()];
+    if (not ref.arena) {
+      ref.dict = proxyDict;
+      ref.arena = boost::make_shared<Arena>(threadStream());
+    }
+    boost::shared_ptr<Arena> arena = ref.arena;
+    lock.unlock();
+    return arena;
+  }
+
+  // Drop arenas of destroyed events
+  void endEvents()
+  {
+    std::vector<boost::shared_ptr<Arena> > ended;
+    boost::mutex::scoped_lock lock(g_arenaMutex);
+    sweepArenas(ended);
+    lock.unlock();
+  }
+
+  void release(void* ptr, size_t size, const boost::shared_ptr<Stream>& stream)
+  {
+    if (not ptr) return;
+    size = blockSize(size);
+
+    {
+      boost::mutex::scoped_lock lock(g_mutex);
+      if (g_cachedBytes + size <= g_cacheLimit) {
+        FreeBlock block;
+        block.ptr = ptr;
+        block.stream = stream;
+        block.epoch = stream ? stream->epoch : 0;
+        block.globalEpoch = g_epoch;
+        g_free[size].push_back(block);
+        g_cachedBytes += size;
+        return;
+      }
+    }
+    free(ptr);
+  }
+
+  void endEvent(const boost::shared_ptr<Stream>& stream)
+  {
+    std::vector<void*> drop;
+    {
+      boost::mutex::scoped_lock lock(g_mutex);
+      ++ stream->epoch;
+      ++ g_epoch;
+      // blocks released by this stream before its previous event ended were
+      // not needed by that event, blocks of streams which do not exist any
+      // more are counted by ends of events in all streams
+      for (FreeLists::iterator it = g_free.begin(); it != g_free.end(); ++ it) {
+        std::vector<FreeBlock>& blocks = it->second;
+        std::vector<FreeBlock>::iterator keep = blocks.begin();
+        for (std::vector<FreeBlock>::iterator bit = blocks.begin(); bit != blocks.end(); ++ bit) {
+          bool stale;
+          if (boost::shared_ptr<Stream> owner = bit->stream.lock()) {
+            stale = owner == stream and bit->epoch + 1 < stream->epoch;
+          } else {
+            stale = bit->globalEpoch + 1 < g_epoch;
+          }
+          if (stale) {
+            drop.push_back(bit->ptr);
+            g_cachedBytes -= it->first;
+          } else {
+            *keep ++ = *bit;
+          }
+        }
+        blocks.erase(keep, blocks.end());
+      }
+    }
+    for (std::vector<void*>::const_iterator it = drop.begin(); it != drop.end(); ++ it) free(*it);
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+void*
+ArrayPool::allocate(size_t size)
+{
+  size = ::blockSize(size);
+
+  bool hugePages = false;
+  {
+    boost::mutex::scoped_lock lock(::g_mutex);
+    FreeLists::iterator it = ::g_free.find(size);
+    if (it != ::g_free.end() and not it->second.empty()) {
+      void* ptr = it->second.back().ptr;
+      it->second.pop_back();
+      ::g_cachedBytes -= size;
+      ++ ::g_reused;
+      return ptr;
+    }
+    ++ ::g_allocated;
+    hugePages = ::g_hugePages and size >= ::HugePageSize;
+  }
+
+  // huge pages need huge page alignment, madvise is only a hint
+  void* ptr = 0;
+  if (posix_memalign(&ptr, hugePages ? ::HugePageSize : size_t(Alignment), size) != 0) {
+    throw std::bad_alloc();
+  }
+#ifdef MADV_HUGEPAGE
+  if (hugePages) madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+}
+
+void
+ArrayPool::release(void* ptr, size_t size)
+{
+  ::release(ptr, size, boost::shared_ptr< ::Stream>());
+}
+
+PyObject*
+ArrayPool::numpyEmpty(PyObject* shape, PyObject* dtype, const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict)
+{
+  PyArray_Dims dims = { 0, 0 };
+  if (not PyArray_IntpConverter(shape, &dims)) return 0;
+
+  // dtype=None means float64, same as numpy.empty()
+  PyArray_Descr* descr = 0;
+  if (not PyArray_DescrConverter2(dtype, &descr)) {
+    PyDimMem_FREE(dims.ptr);
+    return 0;
+  }
+  if (not descr) descr = PyArray_DescrFromType(NPY_DOUBLE);
+  if (PyDataType_REFCHK(descr)) {
+    PyErr_SetString(PyExc_TypeError, "Event.empty(): object dtypes are not supported");
+    Py_DECREF(descr);
+    PyDimMem_FREE(dims.ptr);
+    return 0;
+  }
+
+  // same limit as numpy, total size in bytes must fit npy_intp
+  npy_intp size = descr->elsize;
+  for (int i = 0; i != dims.len; ++ i) {
+    const char* error = 0;
+    if (dims.ptr[i] < 0) {
+      error = "Event.empty(): negative dimensions are not allowed";
+    } else if (dims.ptr[i] > 0 and size > NPY_MAX_INTP / dims.ptr[i]) {
+      error = "Event.empty(): array is too big";
+    }
+    if (error) {
+      PyErr_SetString(PyExc_ValueError, error);
+      Py_DECREF(descr);
+      PyDimMem_FREE(dims.ptr);
+      return 0;
+    }
+    size *= dims.ptr[i];
+  }
+
+  Block* block = 0;
+  try {
+    block = new Block;
+    block->size = size;
+    block->data = 0;
+    block->arena = ::eventArena(proxyDict);
+    block->data = allocate(size);
+  } catch (const std::bad_alloc&) {
+    delete block;
+    Py_DECREF(descr);
+    PyDimMem_FREE(dims.ptr);
+    return PyErr_NoMemory();
+  } catch (const std::exception& ex) {
+    delete block;
+    Py_DECREF(descr);
+    PyDimMem_FREE(dims.ptr);
+    PyErr_SetString(PyExc_RuntimeError, ex.what());
+    return 0;
+  }
+  void* data = block->data;
+
+  // capsule owns the block, it must exist before array so that the block
+  // is not lost if array creation fails
+  PyObject* capsule = PyCapsule_New(block, ::capsuleName, ::releaseCapsule);
+  if (not capsule) {
+    ::release(block->data, block->size, block->arena->stream());
+    delete block;
+    Py_DECREF(descr);
+    PyDimMem_FREE(dims.ptr);
+    return 0;
+  }
+
+  // steals reference to descr
+  PyObject* array = PyArray_NewFromDescr(&PyArray_Type, descr, dims.len, dims.ptr, 0, data, NPY_ARRAY_CARRAY, 0);
+  PyDimMem_FREE(dims.ptr);
+  if (not array) {
+    Py_DECREF(capsule);
+    return 0;
+  }
+
+  PyArrayObject* oarray = (PyArrayObject*)array;
+  oarray->base = capsule;
+
+  return array;
+}
+
+void
+ArrayPool::setHugePages(bool enable)
+{
+  boost::mutex::scoped_lock lock(::g_mutex);
+  ::g_hugePages = enable;
+}
+
+void
+ArrayPool::setCacheLimit(size_t bytes)
+{
+  std::vector<void*> drop;
+  {
+    boost::mutex::scoped_lock lock(::g_mutex);
+    ::g_cacheLimit = bytes;
+    // free largest blocks first until we are within limit
+    for (FreeLists::reverse_iterator it = ::g_free.rbegin(); it != ::g_free.rend() and ::g_cachedBytes > bytes; ++ it) {
+      while (not it->second.empty() and ::g_cachedBytes > bytes) {
+        drop.push_back(it->second.back().ptr);
+        it->second.pop_back();
+        ::g_cachedBytes -= it->first;
+      }
+    }
+  }
+  for (std::vector<void*>::const_iterator it = drop.begin(); it != drop.end(); ++ it) free(*it);
+}
+
+PyObject*
+ArrayPool::asDict()
+{
+  // counters include blocks of events which are gone
+  ::endEvents();
+
+  unsigned long allocated, reused;
+  size_t cachedBytes, cacheLimit;
+  bool hugePages;
+  {
+    boost::mutex::scoped_lock lock(::g_mutex);
+    allocated = ::g_allocated;
+    reused = ::g_reused;
+    cachedBytes = ::g_cachedBytes;
+    cacheLimit = ::g_cacheLimit;
+    hugePages = ::g_hugePages;
+  }
+
+  return Py_BuildValue("{s:k,s:k,s:n,s:n,s:O}", "allocated", allocated, "reused", reused,
+                       "cached_bytes", Py_ssize_t(cachedBytes), "cache_limit", Py_ssize_t(cacheLimit),
+                       "hugepages", hugePages ? Py_True : Py_False);
+}
+
+} // namespace psana_python
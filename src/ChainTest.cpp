@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ChainTest...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ChainTest.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <boost/make_shared.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psana_python/GILReleaser.h"
+#include "PSEvt/Event.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+// This declares this class as psana module
+using namespace psana_python;
+PSANA_MODULE_FACTORY(ChainTest)
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+ChainTest::ChainTest (const std::string& name)
+  : psana::Module(name)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+ChainTest::~ChainTest ()
+{
+}
+
+/// Method which is called with event data
+void
+ChainTest::event(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  const char* state = "inactive";
+  if (GILReleaser::active()) state = GILReleaser::locked() ? "locked" : "released";
+  evt.put(boost::make_shared<std::string>(state), "gil:" + name());
+}
+
+} // namespace psana_python
@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Cache of contiguous copies made by contiguousArray().
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ContiguousArray.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <map>
+#include <stdint.h>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <boost/weak_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  // type, source (log, phy) and key of original object
+  typedef boost::tuple<std::string, uint32_t, uint32_t, std::string> CopyKey;
+
+  struct Copy {
+    boost::weak_ptr<void> original;
+    boost::shared_ptr<void> copy;
+  };
+
+  struct EventCopies {
+    boost::weak_ptr<PSEvt::ProxyDictI> dict;
+    std::map<CopyKey, Copy> copies;
+  };
+
+  typedef std::map<const PSEvt::ProxyDictI*, EventCopies> Cache;
+
+  boost::mutex g_mutex;
+  Cache g_cache;
+
+  CopyKey copyKey(const std::type_info& type, const Pds::Src& src, const std::string& key)
+  {
+    return CopyKey(type.name(), src.log(), src.phy(), key);
+  }
+
+  // Remove copies of destroyed events, they are moved to a list which is
+  // destroyed when cache is not locked any more
+  void sweep(std::vector<boost::shared_ptr<void> >& dropped)
+  {
+    for (Cache::iterator it = g_cache.begin(); it != g_cache.end(); ) {
+      if (it->second.dict.expired()) {
+        for (std::map<CopyKey, Copy>::const_iterator cit = it->second.copies.begin();
+             cit != it->second.copies.end(); ++ cit) {
+          dropped.push_back(cit->second.copy);
+        }
+        g_cache.erase(it ++);
+      } else {
+        ++ it;
+      }
+    }
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+namespace detail {
+
+boost::shared_ptr<void>
+cachedCopy(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict, const std::type_info& type,
+    const Pds::Src& src, const std::string& key, const boost::shared_ptr<void>& original)
+{
+  std::vector<boost::shared_ptr<void> > dropped;
+  boost::mutex::scoped_lock lock(::g_mutex);
+  ::sweep(dropped);
+
+  Cache::const_iterator it = ::g_cache.find(proxyDict.get());
+  if (it == ::g_cache.end()) return boost::shared_ptr<void>();
+  std::map<CopyKey, Copy>::const_iterator cit = it->second.copies.find(::copyKey(type, src, key));
+  if (cit == it->second.copies.end()) return boost::shared_ptr<void>();
+
+  // copy of the object which was replaced since then is not valid
+  if (cit->second.original.lock() != original) return boost::shared_ptr<void>();
+  return cit->second.copy;
+}
+
+boost::shared_ptr<void>
+cacheCopy(const boost::shared_ptr<PSEvt::ProxyDictI>& proxyDict, const std::type_info& type,
+    const Pds::Src& src, const std::string& key, const boost::shared_ptr<void>& original,
+    const boost::shared_ptr<void>& copy)
+{
+  std::vector<boost::shared_ptr<void> > dropped;
+  boost::mutex::scoped_lock lock(::g_mutex);
+  ::sweep(dropped);
+
+  EventCopies& copies = ::g_cache[proxyDict.get()];
+  copies.dict = proxyDict;
+  Copy& entry = copies.copies[::copyKey(type, src, key)];
+  if (entry.copy and entry.original.lock() == original) return entry.copy;
+  dropped.push_back(entry.copy);
+  entry.original = original;
+  entry.copy = copy;
+  return copy;
+}
+
+} // namespace detail
+} // namespace psana_python
@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ContiguousArrayTest...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ContiguousArrayTest.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <sstream>
+#include <stdexcept>
+#include <boost/make_shared.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+#include "psana_python/ContiguousArray.h"
+#include "PSEvt/Event.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+// This declares this class as psana module
+using namespace psana_python;
+PSANA_MODULE_FACTORY(ContiguousArrayTest)
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+ContiguousArrayTest::ContiguousArrayTest (const std::string& name)
+  : psana::Module(name)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+ContiguousArrayTest::~ContiguousArrayTest ()
+{
+}
+
+/// Method which is called with event data
+void
+ContiguousArrayTest::event(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  const PSEvt::Source source(PSEvt::Source::null);
+
+  // 3x4 array viewed as transposed 4x3
+  ndarray<float, 2> data = make_ndarray<float>(3, 4);
+  for (unsigned i = 0; i != data.size(); ++ i) data.data()[i] = i;
+  const unsigned shape[] = { 4, 3 };
+  const int strides[] = { 1, 4 };
+  ndarray<float, 2> transposed(data.data_ptr(), shape);
+  transposed.strides(strides);
+  evt.put(boost::make_shared<ndarray<float, 2> >(transposed), "contiguous_in");
+
+  boost::shared_ptr<ndarray<const float, 2> > first = contiguousArray<float, 2>(evt, source, "contiguous_in");
+  boost::shared_ptr<ndarray<const float, 2> > second = contiguousArray<float, 2>(evt, source, "contiguous_in");
+  evt.put(first, "contiguous_out");
+
+  evt.put(boost::make_shared<ndarray<const float, 2> >(data), "contiguous_corder");
+  boost::shared_ptr<ndarray<const float, 2> > corder = contiguousArray<float, 2>(evt, source, "contiguous_corder");
+
+  evt.put(boost::make_shared<ndarray<float, 2> >(data), "contiguous_both");
+  evt.put(boost::make_shared<ndarray<const float, 2> >(data), "contiguous_both");
+  bool ambiguous = false;
+  try {
+    contiguousArray<float, 2>(evt, source, "contiguous_both");
+  } catch (const std::runtime_error&) {
+    ambiguous = true;
+  }
+
+  std::ostringstream str;
+  str << "same=" << int(first and first == second)
+      << " corder=" << int(corder and corder->data() == data.data())
+      << " ambiguous=" << int(ambiguous);
+  evt.put(boost::make_shared<std::string>(str.str()), "contiguous_test");
+}
+
+} // namespace psana_python
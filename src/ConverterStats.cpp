@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ConverterStats...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ConverterStats.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string.h>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "pytools/make_pyshared.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  // NumPy type numbers for supported types are small, ranks go up to 6
+  const int MaxType = 32;
+  const unsigned MaxRank = 8;
+
+  using psana_python::ConverterStats;
+
+  // all counters, updated with atomic builtins
+  unsigned long g_counts[ConverterStats::NumDirections][MaxType][MaxRank];
+  unsigned long g_zeroCopyBytes = 0;
+  unsigned long g_copiedBytes = 0;
+  unsigned long g_contiguousCopies = 0;
+  unsigned long g_contiguousBytes = 0;
+  unsigned long g_rejects[ConverterStats::NumRejects];
+
+  // type names by NumPy type number, static strings from the first
+  // conversion of each type
+  const char* volatile g_typeNames[MaxType];
+
+  const char* rejectNames[ConverterStats::NumRejects] = {
+    "not_array", "wrong_rank", "wrong_type", "wrong_object"
+  };
+
+  const char* directionNames[ConverterStats::NumDirections] = {
+    "to_numpy", "from_numpy"
+  };
+
+  unsigned long load(unsigned long& counter)
+  {
+    return __sync_fetch_and_add(&counter, 0UL);
+  }
+
+  // Store current value of a counter in a dictionary, returns false and
+  // sets Python exception on errors
+  bool setCounter(PyObject* dict, const char* name, unsigned long& counter)
+  {
+    pytools::pyshared_ptr value = pytools::make_pyshared(PyLong_FromUnsignedLong(load(counter)));
+    return value and PyDict_SetItemString(dict, name, value.get()) == 0;
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+void
+ConverterStats::count(Direction dir, int numpyType, const char* typeName, unsigned rank, size_t zeroCopyBytes)
+{
+  if (numpyType >= 0 and numpyType < MaxType and rank < MaxRank) {
+    if (not g_typeNames[numpyType]) g_typeNames[numpyType] = typeName;
+    __sync_fetch_and_add(&g_counts[dir][numpyType][rank], 1UL);
+  }
+  if (zeroCopyBytes) __sync_fetch_and_add(&g_zeroCopyBytes, (unsigned long)zeroCopyBytes);
+}
+
+void
+ConverterStats::countCopy(size_t bytes)
+{
+  __sync_fetch_and_add(&g_copiedBytes, (unsigned long)bytes);
+}
+
+void
+ConverterStats::countContiguous(size_t bytes)
+{
+  __sync_fetch_and_add(&g_contiguousCopies, 1UL);
+  __sync_fetch_and_add(&g_contiguousBytes, (unsigned long)bytes);
+}
+
+void
+ConverterStats::reject(Reject reason)
+{
+  __sync_fetch_and_add(&g_rejects[reason], 1UL);
+}
+
+PyObject*
+ConverterStats::asDict()
+{
+  pytools::pyshared_ptr result = pytools::make_pyshared(PyDict_New());
+  if (not result) return 0;
+
+  for (int dir = 0; dir != NumDirections; ++ dir) {
+    pytools::pyshared_ptr counts = pytools::make_pyshared(PyDict_New());
+    if (not counts) return 0;
+    for (int type = 0; type != MaxType; ++ type) {
+      for (unsigned rank = 0; rank != MaxRank; ++ rank) {
+        unsigned long count = ::load(g_counts[dir][type][rank]);
+        if (not count) continue;
+        const char* name = g_typeNames[type] ? g_typeNames[type] : "unknown";
+        // names may come from numpy type objects, e.g. "numpy.float64"
+        if (const char* dot = strrchr(name, '.')) name = dot + 1;
+        pytools::pyshared_ptr key = pytools::make_pyshared(Py_BuildValue("(sI)", name, rank));
+        if (not key) return 0;
+        pytools::pyshared_ptr value = pytools::make_pyshared(PyLong_FromUnsignedLong(count));
+        if (not value) return 0;
+        if (PyDict_SetItem(counts.get(), key.get(), value.get()) < 0) return 0;
+      }
+    }
+    if (PyDict_SetItemString(result.get(), directionNames[dir], counts.get()) < 0) return 0;
+  }
+
+  if (not ::setCounter(result.get(), "zero_copy_bytes", g_zeroCopyBytes)) return 0;
+  if (not ::setCounter(result.get(), "copied_bytes", g_copiedBytes)) return 0;
+  if (not ::setCounter(result.get(), "contiguous_copies", g_contiguousCopies)) return 0;
+  if (not ::setCounter(result.get(), "contiguous_bytes", g_contiguousBytes)) return 0;
+
+  pytools::pyshared_ptr rejects = pytools::make_pyshared(PyDict_New());
+  if (not rejects) return 0;
+  for (int reason = 0; reason != NumRejects; ++ reason) {
+    if (not ::setCounter(rejects.get(), rejectNames[reason], g_rejects[reason])) return 0;
+  }
+  if (PyDict_SetItemString(result.get(), "rejected", rejects.get()) < 0) return 0;
+
+  Py_INCREF(result.get());
+  return result.get();
+}
+
+void
+ConverterStats::reset()
+{
+  for (int dir = 0; dir != NumDirections; ++ dir) {
+    for (int type = 0; type != MaxType; ++ type) {
+      for (unsigned rank = 0; rank != MaxRank; ++ rank) {
+        __sync_lock_test_and_set(&g_counts[dir][type][rank], 0UL);
+      }
+    }
+  }
+  __sync_lock_test_and_set(&g_zeroCopyBytes, 0UL);
+  __sync_lock_test_and_set(&g_copiedBytes, 0UL);
+  __sync_lock_test_and_set(&g_contiguousCopies, 0UL);
+  __sync_lock_test_and_set(&g_contiguousBytes, 0UL);
+  for (int reason = 0; reason != NumRejects; ++ reason) {
+    __sync_lock_test_and_set(&g_rejects[reason], 0UL);
+  }
+}
+
+} // namespace psana_python
@@ -46,6 +46,7 @@
 #include "psana_python/PythonModule.h"
 #include "psana_python/Source.h"
 #include "psana_python/SrcMatch.h"
+#include "psana_python/StartupTrace.h"
 #include "psddl_python/ConverterMap.h"
 #include "psddl_python/ConverterFun.h"
 #include "psddl_python/CreateDeviceWrappers.h"
@@ -73,6 +74,8 @@ namespace {
   _createWrappers(PyObject* module)
   {
 
+    psana_python::StartupTrace trace("createWrappers");
+
     // initialize all local types
     psana_python::AliasMap::initType(module);
     psana_python::DgramList::initType(module);
@@ -105,8 +108,12 @@ namespace {
     // register converter for standard Python str (takes no module argument)
     cmap.addConverter(boost::make_shared<psana_python::StringCvt>());
 
-    // instantiate all sub-modules
-    psddl_python::createDeviceWrappers(module);
+    // instantiate all sub-modules, they must exist when module is imported
+    // so that "from _psana import *" sees them
+    {
+      psana_python::StartupTrace trace("createWrappers: device wrappers");
+      psddl_python::createDeviceWrappers(module);
+    }
 
     // to help boost we need to register convertes for several types that we define here
     boost::python::to_python_converter<Pds::Src, PdsSrcConverter<Pds::Src, psana_python::PdsSrc>, true>();
@@ -117,11 +124,17 @@ namespace {
 
     // must be after psddl_python as it needs numpy initialization which
     // happens in psddl_python
-    psana_python::initNdarrayCvt(cmap, module);
-    cmap.addConverter(boost::make_shared<psana_python::Ndarray2CppCvt>());
+    {
+      psana_python::StartupTrace trace("createWrappers: ndarray converters");
+      psana_python::initNdarrayCvt(cmap, module);
+      cmap.addConverter(boost::make_shared<psana_python::Ndarray2CppCvt>());
+    }
 
     // Add additional python converters
-    psana_python::createConverters();
+    {
+      psana_python::StartupTrace trace("createWrappers: boost.python converters");
+      psana_python::createConverters();
+    }
     
     // add few constants
     PyModule_AddIntConstant(module, "Normal", psana_python::PythonModule::Normal);
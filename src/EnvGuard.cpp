@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class EnvGuard...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/EnvGuard.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <algorithm>
+#include <list>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "PSEnv/Env.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  // objects of environment which are updated while events are processed
+  enum { NumObjects = 4 };
+
+  struct Registration {
+    const void* objects[NumObjects];
+    boost::weak_ptr<psana_python::EnvGuard::Client> client;
+    const psana_python::EnvGuard::Client* ptr;  // for comparison with new clients
+  };
+
+  typedef std::list<Registration> Registry;
+
+  // registered clients, count is checked without mutex so that nothing
+  // is paid when there is no background thread
+  boost::mutex g_mutex;
+  Registry g_registry;
+  unsigned long g_count = 0;
+
+  // set in background threads of clients
+  __thread bool t_background = false;
+
+  void envObjects(PSEnv::Env& env, const void* objects[NumObjects])
+  {
+    objects[0] = &env.configStore();
+    objects[1] = &env.calibStore();
+    objects[2] = &env.epicsStore();
+    objects[3] = env.aliasMap().get();
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+void
+EnvGuard::add(PSEnv::Env& env, const boost::shared_ptr<Client>& client)
+{
+  Registration reg;
+  ::envObjects(env, reg.objects);
+  reg.client = client;
+  reg.ptr = client.get();
+
+  // this may be called without GIL, clients are not locked here because
+  // their destructors need GIL
+  boost::mutex::scoped_lock lock(g_mutex);
+  bool found = false;
+  for (Registry::iterator it = g_registry.begin(); it != g_registry.end(); ) {
+    if (it->client.expired()) {
+      g_registry.erase(it ++);
+    } else {
+      if (it->ptr == client.get()) found = true;
+      ++ it;
+    }
+  }
+  if (not found) g_registry.push_back(reg);
+  __sync_lock_test_and_set(&g_count, g_registry.size());
+}
+
+void
+EnvGuard::setBackground()
+{
+  t_background = true;
+}
+
+void
+EnvGuard::use(const void* obj)
+{
+  if (t_background or __sync_fetch_and_add(&g_count, 0UL) == 0) return;
+
+  // clients of this environment are removed from registry, they do not
+  // update it in background any more once stopped
+  std::vector<boost::shared_ptr<Client> > clients;
+  {
+    boost::mutex::scoped_lock lock(g_mutex);
+    for (Registry::iterator it = g_registry.begin(); it != g_registry.end(); ) {
+      boost::shared_ptr<Client> client = it->client.lock();
+      if (client and std::find(it->objects, it->objects + NumObjects, obj) == it->objects + NumObjects) {
+        ++ it;
+        continue;
+      }
+      if (client) clients.push_back(client);
+      g_registry.erase(it ++);
+    }
+    __sync_lock_test_and_set(&g_count, g_registry.size());
+  }
+  if (clients.empty()) return;
+
+  // background thread may need GIL to run Python modules, clients are
+  // released after GIL is restored
+  PyThreadState* threadState = PyEval_SaveThread();
+  for (std::vector<boost::shared_ptr<Client> >::const_iterator it = clients.begin(); it != clients.end(); ++ it) {
+    (*it)->stopBackground();
+  }
+  PyEval_RestoreThread(threadState);
+}
+
+} // namespace psana_python
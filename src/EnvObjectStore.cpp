@@ -33,6 +33,7 @@
 // Collaborating Class Headers --
 //-------------------------------
 #include "PSEvt/ProxyDict.h"
+#include "psana_python/EnvGuard.h"
 #include "psana_python/EventKey.h"
 #include "psana_python/PdsSrc.h"
 #include "psana_python/Source.h"
@@ -145,6 +146,7 @@ PyObject*
 EnvObjectStore_keys(PyObject* self, PyObject* args)
 {
   boost::shared_ptr<PSEnv::EnvObjectStore>& cself = EnvObjectStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
   return ProxyDictMethods::keys(*cself->proxyDict(), args);
 }
 
@@ -167,6 +169,7 @@ EnvObjectStore_get(PyObject* self, PyObject* args)
    */
 
   boost::shared_ptr<PSEnv::EnvObjectStore>& cself = psana_python::EnvObjectStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   int nargs = PyTuple_GET_SIZE(args);
   if (nargs < 1 or nargs > 3) {
@@ -244,6 +247,7 @@ try {
    */
 
   boost::shared_ptr<PSEnv::EnvObjectStore>& cself = psana_python::EnvObjectStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   int nargs = PyTuple_GET_SIZE(args);
   if (nargs < 1 or nargs > 3) {
@@ -29,6 +29,7 @@
 // Collaborating Class Headers --
 //-------------------------------
 #include "psddl_psana/epics.ddl.h"
+#include "psana_python/EnvGuard.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -126,6 +127,7 @@ PyObject*
 EpicsStore_names(PyObject* self, PyObject* )
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
   return nameList(cself->names());
 }
 
@@ -133,6 +135,7 @@ PyObject*
 EpicsStore_pvNames(PyObject* self, PyObject* )
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
   return nameList(cself->pvNames());
 }
 
@@ -140,6 +143,7 @@ PyObject*
 EpicsStore_aliases(PyObject* self, PyObject* )
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
   return nameList(cself->aliases());
 }
 
@@ -147,6 +151,7 @@ PyObject*
 EpicsStore_alias(PyObject* self, PyObject* args)
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* arg;
   if (not PyArg_ParseTuple( args, "s:EpicsStore.alias", &arg)) return 0;
@@ -163,6 +168,7 @@ PyObject*
 EpicsStore_pvName(PyObject* self, PyObject* args)
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* arg;
   if (not PyArg_ParseTuple( args, "s:EpicsStore.pvName", &arg)) return 0;
@@ -179,6 +185,7 @@ PyObject*
 EpicsStore_value(PyObject* self, PyObject* args)
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* name;
   unsigned index = 0;
@@ -267,6 +274,7 @@ PyObject*
 EpicsStore_status(PyObject* self, PyObject* args)
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* arg;
   if (not PyArg_ParseTuple( args, "s:EpicsStore.status", &arg)) return 0;
@@ -297,6 +305,7 @@ PyObject*
 EpicsStore_getPV(PyObject* self, PyObject* args)
 {
   const boost::shared_ptr<PSEnv::EpicsStore>& cself = psana_python::EpicsStore::cppObject(self);
+  psana_python::EnvGuard::use(cself.get());
 
   const char* name;
   if (not PyArg_ParseTuple( args, "s:EpicsStore.status", &name)) return 0;
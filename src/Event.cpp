@@ -38,6 +38,8 @@
 #include "psana_python/EventKey.h"
 #include "psana_python/PdsSrc.h"
 #include "psana_python/Source.h"
+#include "psana_python/ArrayConvert.h"
+#include "psana_python/ArrayPool.h"
 #include "psana_python/ProxyDictMethods.h"
 #include "pytools/make_pyshared.h"
 #include "pytools/PyUtil.h"
@@ -56,14 +58,16 @@ namespace {
 
   // type-specific methods
   PyObject* Event_keys(PyObject* self, PyObject* args);
-  PyObject* Event_get(PyObject* self, PyObject* args);
+  PyObject* Event_get(PyObject* self, PyObject* args, PyObject* kwds);
+  PyObject* Event_get_args(PyObject* self, PyObject* args);
   PyObject* Event_put(PyObject* self, PyObject* args);
   PyObject* Event_remove(PyObject* self, PyObject* args);
   PyObject* Event_run(PyObject* self, PyObject* args);
+  PyObject* Event_empty(PyObject* self, PyObject* args, PyObject* kwds);
 
   PyMethodDef methods[] = {
-    { "get",  Event_get,  METH_VARARGS, 
-        "self.get(...) -> object\n\n"
+    { "get",  (PyCFunction)Event_get,  METH_VARARGS | METH_KEYWORDS,
+        "self.get(..., dtype=None, out=None) -> object\n\n"
         "Finds and retrieves objects from event. This is an overloaded method which "
         "can accept variable number of parameters:\n"
         " * ``get(type, src, key:string)``\n"
@@ -79,7 +83,13 @@ namespace {
         " * ``get(int)`` - equivalent to ``get(int, \"\")``\n\n"
         "In the first four methods type argument can be a type object or a list of type objects. "
         "If the list is given then object is returned whose type matches any one from the list. "
-        "The src argument can be an instance of :py:class:`Source` or :py:class:`Src` types."},
+        "The src argument can be an instance of :py:class:`Source` or :py:class:`Src` types.\n\n"
+        "If ``dtype`` keyword argument is given returned array is converted to that type, e.g. "
+        "``get(ndarray_uint16_2, src, dtype=numpy.float32)``; conversion runs without GIL and the array is "
+        "returned without copy if it already has that type. "
+        "If ``out`` keyword argument is given it must be a writeable numpy array of the same shape as "
+        "returned array, data are copied into it (converting element type if needed) and ``out`` is returned "
+        "instead of a new array. If nothing is found None is returned and ``out`` is not changed."},
     { "put",  Event_put,  METH_VARARGS, 
         "self.put(...) -> None\n\n"
         "Store new object in the event. This is an overloaded method which "
@@ -105,6 +115,13 @@ namespace {
     { "run",  Event_run,  METH_NOARGS,
         "self.run() -> int\n\nGet the run number form event. If run number is not known -1 is returned. "
         "This is a pyana compatibility method which is deprectated."},
+    { "empty",  (PyCFunction)Event_empty,  METH_VARARGS | METH_KEYWORDS,
+        "self.empty(shape, dtype=float) -> numpy.ndarray\n\nMake new numpy array with uninitialized data, "
+        "same as ``numpy.empty(shape, dtype)`` but data are 64-byte aligned and come from a pool of memory "
+        "blocks which are reused by the following events. Memory goes back to the pool when the array and "
+        "all objects sharing its data are gone, for arrays stored in the event with ``put()`` this happens "
+        "when event is destroyed. Blocks which are not reused by the next event are freed. Use it for "
+        "large arrays made for every event."},
     {0, 0, 0, 0}
    };
 
@@ -170,8 +187,34 @@ Event_keys(PyObject* self, PyObject* args)
 }
 
 
+PyObject*
+Event_get(PyObject* self, PyObject* args, PyObject* kwds)
+{
+  // keyword arguments apply to the returned object
+  PyObject* dtype = 0;
+  PyObject* out = 0;
+  if (kwds) {
+    Py_ssize_t pos = 0;
+    PyObject* kw;
+    PyObject* value;
+    while (PyDict_Next(kwds, &pos, &kw, &value)) {
+      const std::string name = PyString_AsString_Compatible(kw);
+      if (name == "dtype") {
+        dtype = value;
+      } else if (name == "out") {
+        out = value;
+      } else {
+        return PyErr_Format(PyExc_TypeError, "Event.get(): unexpected keyword argument '%s'",
+                            PyString_AsString_Compatible(kw));
+      }
+    }
+  }
+
+  return psana_python::applyGetOptions(Event_get_args(self, args), dtype, out);
+}
+
 PyObject* 
-Event_get(PyObject* self, PyObject* args)
+Event_get_args(PyObject* self, PyObject* args)
 try {
   /*
    *  get(...) is very overloaded method, here is the list of possible argument combinations:
@@ -364,4 +407,17 @@ Event_run(PyObject* self, PyObject* args)
 #endif
 }
 
+// make array with memory from pool
+PyObject*
+Event_empty(PyObject* self, PyObject* args, PyObject* kwds)
+{
+  static char* kwlist[] = {const_cast<char*>("shape"), const_cast<char*>("dtype"), 0};
+  PyObject* shape = 0;
+  PyObject* dtype = 0;
+  if (not PyArg_ParseTupleAndKeywords(args, kwds, "O|O:Event.empty", kwlist, &shape, &dtype)) return 0;
+
+  boost::shared_ptr<PSEvt::Event>& cself = psana_python::Event::cppObject(self);
+  return psana_python::ArrayPool::numpyEmpty(shape, dtype, cself->proxyDict());
+}
+
 }
@@ -29,6 +29,7 @@
 //-------------------------------
 #include "psana_python/PdsBldInfo.h"
 #include "psana_python/PdsDetInfo.h"
+#include "psana_python/ObjectLock.h"
 #include "psana_python/PdsProcInfo.h"
 #include "psddl_python/ConverterMap.h"
 #include "pytools/PyUtil.h"
@@ -43,6 +44,7 @@ using psddl_python::Converter;
 namespace {
 
   std::string type_name(PyTypeObject*);
+  PyTypeObject* py_type(const std::type_info* typeinfo);
 
   // type-specific methods
   PyObject* EventKey_type(PyObject* self, PyObject*);
@@ -86,9 +88,7 @@ psana_python::EventKey::print(std::ostream& out) const
     if (typeinfo == &typeid(const PyObject)) {
       type = "object";
     } else {
-      const ConverterMap::CvtList& cvt = ConverterMap::instance().getFromCppConverters(typeinfo);
-      if (not cvt.empty()) {
-        PyTypeObject* tobj = cvt[0]->to_py_types()[0];
+      if (PyTypeObject* tobj = ::py_type(typeinfo)) {
         type = ::type_name(tobj);
       }
     }
@@ -131,16 +131,25 @@ type_name(PyTypeObject* type)
   return name;
 }
 
+// Find Python type for C++ type in converter map, returns borrowed reference
+// or zero if there is no converter
+PyTypeObject*
+py_type(const std::type_info* typeinfo)
+{
+  psana_python::ObjectLock lock(&ConverterMap::instance(), psana_python::ObjectLock::Converters);
+  const ConverterMap::CvtList& cvt = ConverterMap::instance().getFromCppConverters(typeinfo);
+  if (cvt.empty()) return 0;
+  return cvt[0]->to_py_types()[0];
+}
+
 PyObject*
 EventKey_type(PyObject* self, PyObject* )
 {
   PSEvt::EventKey& cself = psana_python::EventKey::cppObject(self);
   if (const std::type_info* typeinfo = cself.typeinfo()) {
-    const ConverterMap::CvtList& cvt = ConverterMap::instance().getFromCppConverters(typeinfo);
-    for (ConverterMap::CvtList::const_iterator it = cvt.begin(); it != cvt.end(); ++ it) {
-      PyObject* res = (PyObject*)(cvt[0]->to_py_types()[0]);
-      Py_INCREF(res);
-      return res;
+    if (PyTypeObject* type = ::py_type(typeinfo)) {
+      Py_INCREF(type);
+      return (PyObject*)type;
     }
   }
   Py_RETURN_NONE;
@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class GILReleaser...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/GILReleaser.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  // Per-thread state of the innermost scope. Non-zero thread state means
+  // that GIL is currently released by the scope, zero means that either
+  // there is no scope or GIL was taken back by Python modules.
+  __thread bool t_active = false;
+  __thread PyThreadState* t_savedState = 0;
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+GILReleaser::GILReleaser()
+  : m_prevState(t_savedState)
+  , m_prevActive(t_active)
+{
+  t_savedState = PyEval_SaveThread();
+  t_active = true;
+}
+
+//--------------
+// Destructor --
+//--------------
+GILReleaser::~GILReleaser()
+{
+  if (t_savedState) PyEval_RestoreThread(t_savedState);
+  t_savedState = m_prevState;
+  t_active = m_prevActive;
+}
+
+bool
+GILReleaser::active()
+{
+  return t_active;
+}
+
+bool
+GILReleaser::locked()
+{
+  return t_active and not t_savedState;
+}
+
+void
+GILReleaser::acquire()
+{
+  if (t_active and t_savedState) {
+    PyEval_RestoreThread(t_savedState);
+    t_savedState = 0;
+  }
+}
+
+void
+GILReleaser::release()
+{
+  if (t_active and not t_savedState) {
+    t_savedState = PyEval_SaveThread();
+  }
+}
+
+} // namespace psana_python
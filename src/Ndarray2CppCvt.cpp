@@ -18,6 +18,9 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <algorithm>
+#include <string.h>
+#include <boost/checked_delete.hpp>
 #include <boost/make_shared.hpp>
 
 //-------------------------------
@@ -25,7 +28,10 @@
 //-------------------------------
 #include "MsgLogger/MsgLogger.h"
 #include "ndarray/ndarray.h"
+#include "psana_python/ConverterStats.h"
+#include "psana_python/GILReleaser.h"
 #include "psddl_python/psddl_python_numpy.h"
+#include "psana_python/NdarrayWrapper.h"
 #include "PSEvt/DataProxy.h"
 #include "pytools/make_pyshared.h"
 
@@ -35,6 +41,34 @@
 
 namespace {
 
+  // Releases buffer view when the last ndarray which uses its data is gone,
+  // this can happen in any thread
+  struct BufferReleaser {
+    void operator()(Py_buffer* view) const {
+      if (Py_IsInitialized()) {
+        psana_python::GILLocker gil;
+        PyBuffer_Release(view);
+      }
+      delete view;
+    }
+  };
+
+  // Copy strided data into C-ordered array reversing bytes in every element,
+  // returns pointer past last copied element
+  char* copySwapped(const char* src, char* dst, int rank, const Py_ssize_t shape[], const Py_ssize_t strides[],
+      size_t itemsize)
+  {
+    for (Py_ssize_t i = 0; i != shape[0]; ++ i, src += strides[0]) {
+      if (rank > 1) {
+        dst = copySwapped(src, dst, rank-1, shape+1, strides+1, itemsize);
+      } else {
+        std::reverse_copy(src, src+itemsize, dst);
+        dst += itemsize;
+      }
+    }
+    return dst;
+  }
+
   template <typename T, unsigned Rank>
   void makeAndSave(const boost::shared_ptr<T>& data, const unsigned shape[], const int strides[],
       PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key, bool modifiable)
@@ -65,13 +99,62 @@ namespace {
     proxyDict.put(proxyPtr, evKey);
   }
 
+  /*
+   *  Save array data in event as ndarray, owner keeps data alive, strides are
+   *  in bytes (zero pointer for C order). Data are shared with owner except
+   *  when byte order is not native, then they are copied once into C-ordered
+   *  array swapping bytes on the way.
+   */
   template <typename T>
-  bool makeAndSave(int rank, pytools::pyshared_ptr shndarr, const unsigned shape[], const int strides[],
-      PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key, bool modifiable)
+  bool saveArray(int rank, boost::shared_ptr<void> owner, const char* data, const Py_ssize_t dims[],
+      const Py_ssize_t byteStrides[], bool swapped, PSEvt::ProxyDictI& proxyDict, const Pds::Src& source,
+      const std::string& key, bool modifiable)
   {
-    boost::shared_ptr<T> dataptr(shndarr, static_cast<T*>(PyArray_DATA(shndarr.get())));
+    if (rank < 1 or rank > 6) {
+      psana_python::ConverterStats::reject(psana_python::ConverterStats::WrongRank);
+      return false;
+    }
+
+    unsigned shape[rank];
+    int strides[rank];
+    size_t size = 1;
+    for (int i = 0; i != rank; ++ i) {
+      shape[i] = dims[i];
+      size *= dims[i];
+    }
+
+    size_t zeroCopyBytes = 0;
+    if (swapped and sizeof(T) > 1) {
+      boost::shared_ptr<T> copy(new T[size], boost::checked_array_deleter<T>());
+      if (size) {
+        Py_ssize_t cstrides[rank];
+        if (not byteStrides) {
+          cstrides[rank-1] = sizeof(T);
+          for (int i = rank-1; i > 0; -- i) cstrides[i-1] = cstrides[i] * dims[i];
+          byteStrides = cstrides;
+        }
+        copySwapped(data, reinterpret_cast<char*>(copy.get()), rank, dims, byteStrides, sizeof(T));
+      }
+      owner = copy;
+      data = reinterpret_cast<const char*>(copy.get());
+      byteStrides = 0;
+      psana_python::ConverterStats::countCopy(size*sizeof(T));
+    } else {
+      zeroCopyBytes = size*sizeof(T);
+    }
+
+    if (byteStrides) {
+      for (int i = 0; i != rank; ++ i) {
+        // ndarray strides are in elements
+        if (byteStrides[i] % Py_ssize_t(sizeof(T))) return false;
+        strides[i] = byteStrides[i] / Py_ssize_t(sizeof(T));
+      }
+    } else {
+      strides[rank-1] = 1;
+      for (int i = rank-1; i > 0; -- i) strides[i-1] = strides[i] * shape[i];
+    }
 
-    bool res = true;
+    boost::shared_ptr<T> dataptr(owner, reinterpret_cast<T*>(const_cast<char*>(data)));
     switch (rank) {
     case 1:
       makeAndSave<T, 1>(dataptr, shape, strides, proxyDict, source, key, modifiable);
@@ -91,10 +174,132 @@ namespace {
     case 6:
       makeAndSave<T, 6>(dataptr, shape, strides, proxyDict, source, key, modifiable);
       break;
+    }
+
+    psana_python::ConverterStats::count(psana_python::ConverterStats::FromNumpy,
+        psana_python::NdarrayTraits<T>::numpyType(), psana_python::NdarrayTraits<T>::typeName(),
+        rank, zeroCopyBytes);
+    return true;
+  }
+
+  // dispatch on NumPy type number
+  bool saveArray(int npyType, int rank, const boost::shared_ptr<void>& owner, const char* data,
+      const Py_ssize_t dims[], const Py_ssize_t byteStrides[], bool swapped, PSEvt::ProxyDictI& proxyDict,
+      const Pds::Src& source, const std::string& key, bool modifiable)
+  {
+    switch (npyType) {
+    case NPY_INT8:
+      return saveArray<int8_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_UINT8:
+      return saveArray<uint8_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_INT16:
+      return saveArray<int16_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_UINT16:
+      return saveArray<uint16_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_INT32:
+      return saveArray<int32_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_UINT32:
+      return saveArray<uint32_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_INT64:
+      return saveArray<int64_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_UINT64:
+      return saveArray<uint64_t>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_FLOAT32:
+      return saveArray<float>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
+    case NPY_FLOAT64:
+      return saveArray<double>(rank, owner, data, dims, byteStrides, swapped, proxyDict, source, key, modifiable);
     default:
-      res = false;
+      psana_python::ConverterStats::reject(psana_python::ConverterStats::WrongType);
+      return false;
     }
-    return res;
+  }
+
+  // C++ type of ndarray which saveArray() makes for given element type, rank and constness
+  template <typename T>
+  const std::type_info* arrayType(int rank, bool modifiable)
+  {
+    switch (rank) {
+    case 1: return modifiable ? &typeid(ndarray<T, 1>) : &typeid(ndarray<const T, 1>);
+    case 2: return modifiable ? &typeid(ndarray<T, 2>) : &typeid(ndarray<const T, 2>);
+    case 3: return modifiable ? &typeid(ndarray<T, 3>) : &typeid(ndarray<const T, 3>);
+    case 4: return modifiable ? &typeid(ndarray<T, 4>) : &typeid(ndarray<const T, 4>);
+    case 5: return modifiable ? &typeid(ndarray<T, 5>) : &typeid(ndarray<const T, 5>);
+    case 6: return modifiable ? &typeid(ndarray<T, 6>) : &typeid(ndarray<const T, 6>);
+    }
+    return 0;
+  }
+
+  // dispatch on NumPy type number
+  const std::type_info* arrayType(int npyType, int rank, bool modifiable)
+  {
+    switch (npyType) {
+    case NPY_INT8: return arrayType<int8_t>(rank, modifiable);
+    case NPY_UINT8: return arrayType<uint8_t>(rank, modifiable);
+    case NPY_INT16: return arrayType<int16_t>(rank, modifiable);
+    case NPY_UINT16: return arrayType<uint16_t>(rank, modifiable);
+    case NPY_INT32: return arrayType<int32_t>(rank, modifiable);
+    case NPY_UINT32: return arrayType<uint32_t>(rank, modifiable);
+    case NPY_INT64: return arrayType<int64_t>(rank, modifiable);
+    case NPY_UINT64: return arrayType<uint64_t>(rank, modifiable);
+    case NPY_FLOAT32: return arrayType<float>(rank, modifiable);
+    case NPY_FLOAT64: return arrayType<double>(rank, modifiable);
+    }
+    return 0;
+  }
+
+  /*
+   *  Map buffer format (struct module syntax) to NumPy type number, only
+   *  single items of supported types are accepted, returns -1 otherwise.
+   *  Sets swapped to true if byte order is not native.
+   */
+  int bufferType(const char* format, Py_ssize_t itemsize, bool& swapped)
+  {
+    // no format means unsigned bytes
+    if (not format) format = "B";
+
+    const uint16_t one = 1;
+    const bool little = *reinterpret_cast<const char*>(&one) == 1;
+
+    swapped = false;
+    switch (*format) {
+    case '@':
+    case '=':
+      ++ format;
+      break;
+    case '<':
+      swapped = not little;
+      ++ format;
+      break;
+    case '>':
+    case '!':
+      swapped = little;
+      ++ format;
+      break;
+    }
+    if (format[0] == '\0' or format[1] != '\0') return -1;
+
+    // size of integer types depends on byte order prefix, use item size
+    const char code = format[0];
+    if (strchr("bhilq", code)) {
+      switch (itemsize) {
+      case 1: return NPY_INT8;
+      case 2: return NPY_INT16;
+      case 4: return NPY_INT32;
+      case 8: return NPY_INT64;
+      }
+    } else if (strchr("BHILQ", code)) {
+      switch (itemsize) {
+      case 1: return NPY_UINT8;
+      case 2: return NPY_UINT16;
+      case 4: return NPY_UINT32;
+      case 8: return NPY_UINT64;
+      }
+    } else if (code == 'f' and itemsize == 4) {
+      return NPY_FLOAT32;
+    } else if (code == 'd' and itemsize == 8) {
+      return NPY_FLOAT64;
+    }
+    return -1;
   }
 }
 
@@ -159,56 +364,66 @@ Ndarray2CppCvt::convert(PyObject* obj, PSEvt::ProxyDictI& proxyDict, const Pds::
   // make shared pointer, do not steal
   pytools::pyshared_ptr shndarr = pytools::make_pyshared(obj, false);
 
-  // dimensions
+  // dimensions, numpy strides are in bytes
   const int rank = PyArray_NDIM(obj);
-  const int itemsize = PyArray_ITEMSIZE(obj);
-  unsigned shape[rank];
-  int strides[rank];
+  Py_ssize_t shape[rank];
+  Py_ssize_t strides[rank];
   for (int i = 0; i != rank; ++ i) {
     shape[i] = PyArray_DIM(obj, i);
-    strides[i] = PyArray_STRIDE(obj, i) / itemsize; // numpy strides are in bytes
+    strides[i] = PyArray_STRIDE(obj, i);
   }
 
   bool modifiable = PyArray_CHKFLAGS(obj, NPY_WRITEABLE);
+  bool swapped = not PyArray_ISNOTSWAPPED(obj);
+
+  return ::saveArray(PyArray_TYPE(obj), rank, shndarr, PyArray_BYTES(obj), shape, strides, swapped,
+                     proxyDict, source, key, modifiable);
+}
+
+// Convert object exporting buffer protocol to C++
+bool
+Ndarray2CppCvt::convertBuffer(PyObject* obj, PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key)
+{
+  if (not PyObject_CheckBuffer(obj)) return false;
+
+  // view is released when ndarray data are not used anymore
+  Py_buffer* view = new Py_buffer;
+  if (PyObject_GetBuffer(obj, view, PyBUF_RECORDS_RO) < 0) {
+    PyErr_Clear();
+    delete view;
+    ConverterStats::reject(ConverterStats::NotArray);
+    return false;
+  }
+  boost::shared_ptr<Py_buffer> owner(view, ::BufferReleaser());
+
+  bool swapped = false;
+  int npyType = ::bufferType(view->format, view->itemsize, swapped);
+  if (npyType < 0) {
+    ConverterStats::reject(ConverterStats::WrongType);
+    return false;
+  }
+
+  return ::saveArray(npyType, view->ndim, owner, static_cast<const char*>(view->buf), view->shape, view->strides,
+                     swapped, proxyDict, source, key, not view->readonly);
+}
+
+// C++ type of ndarray which convertBuffer() makes from an object
+const std::type_info*
+Ndarray2CppCvt::bufferArrayType(PyObject* obj)
+{
+  if (not PyObject_CheckBuffer(obj)) return 0;
 
-  bool result = true;
-  switch (PyArray_TYPE(obj)) {
-  case NPY_INT8:
-    result = makeAndSave<int8_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_UINT8:
-    result = makeAndSave<uint8_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_INT16:
-    result = makeAndSave<int16_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_UINT16:
-    result = makeAndSave<uint16_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_INT32:
-    result = makeAndSave<int32_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_UINT32:
-    result = makeAndSave<uint32_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_INT64:
-    result = makeAndSave<int64_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_UINT64:
-    result = makeAndSave<uint64_t>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_FLOAT32:
-    result = makeAndSave<float>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  case NPY_FLOAT64:
-    result = makeAndSave<double>(rank, shndarr, shape, strides, proxyDict, source, key, modifiable);
-    break;
-  default:
-    result = false;
-    break;
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) < 0) {
+    PyErr_Clear();
+    return 0;
   }
 
-  return result;
+  bool swapped = false;
+  int npyType = ::bufferType(view.format, view.itemsize, swapped);
+  const std::type_info* type = npyType < 0 ? 0 : ::arrayType(npyType, view.ndim, not view.readonly);
+  PyBuffer_Release(&view);
+  return type;
 }
 
 } // namespace psana_python
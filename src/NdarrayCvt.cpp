@@ -18,9 +18,10 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <list>
+#include <map>
 #include <stdexcept>
 #include <sstream>
-#include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/preprocessor/seq/for_each_product.hpp>
 #include <boost/preprocessor/seq/elem.hpp>
@@ -31,117 +32,168 @@
 #include "ndarray/ndarray.h"
 #include "psddl_python/ConverterMap.h"
 #include "psddl_python/psddl_python_numpy.h"
-#include "pytools/PyDataType.h"
+#include "psana_python/ConverterStats.h"
+#include "psana_python/NdarrayWrapper.h"
+#include "PSEvt/EventKey.h"
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
 //-----------------------------------------------------------------------
 
-// set of ranks and types for which we instantiate converters
-// if you extend ND_TYPES macro also add specialization of Traits struct below
-#define ND_RANKS (1)(2)(3)(4)(5)(6)
-#define ND_TYPES (int8_t)(uint8_t)(int16_t)(uint16_t)(int32_t)(uint32_t)(int64_t)(uint64_t)(float)(double)
+namespace psana_python {
+
+// One row of the table of supported ndarray types
+struct NdarrayCvt::Entry {
+  const char* typeName;                 // element type name, e.g. "float64"
+  unsigned rank;
+  const std::type_info* type;           // ndarray<T, Rank>
+  const std::type_info* constType;      // ndarray<const T, Rank>
+  PyTypeObject* (*wrapperType)();       // returns wrapper type, initializes it once
+  PyObject* (*toNumpy)(const boost::shared_ptr<void>& vdata, bool isConst);
+};
+
+}
 
 namespace {
 
   const char logger[] = "psana_python.NdarrayCvt";
 
+  using psana_python::NdarrayCvt;
 
-  // type traits for selected set of C++ types that we support as
-  // elements of ndarrays
-  template <typename T> struct Traits {};
-  template <> struct Traits<int8_t> {
-    static const char* typeName() { return "int8"; }
-    static int numpyType() { return NPY_INT8; }
-  };
-  template <> struct Traits<uint8_t> {
-    static const char* typeName() { return "uint8"; }
-    static int numpyType() { return NPY_UINT8; }
-  };
-  template <> struct Traits<int16_t> {
-    static const char* typeName() { return "int16"; }
-    static int numpyType() { return NPY_INT16; }
-  };
-  template <> struct Traits<uint16_t> {
-    static const char* typeName() { return "uint16"; }
-    static int numpyType() { return NPY_UINT16; }
-  };
-  template <> struct Traits<int32_t> {
-    static const char* typeName() { return "int32"; }
-    static int numpyType() { return NPY_INT32; }
-  };
-  template <> struct Traits<uint32_t> {
-    static const char* typeName() { return "uint32"; }
-    static int numpyType() { return NPY_UINT32; }
-  };
-  template <> struct Traits<int64_t> {
-    static const char* typeName() { return "int64"; }
-    static int numpyType() { return NPY_INT64; }
-  };
-  template <> struct Traits<uint64_t> {
-    static const char* typeName() { return "uint64"; }
-    static int numpyType() { return NPY_UINT64; }
-  };
-  template <> struct Traits<float> {
-    static const char* typeName() { return "float32"; }
-    static int numpyType() { return NPY_FLOAT32; }
-  };
-  template <> struct Traits<double> {
-    static const char* typeName() { return "float64"; }
-    static int numpyType() { return NPY_FLOAT64; }
-  };
+  // module where wrapper types are registered
+  PyObject* g_module = 0;
 
-  // Type for Python objects that will hold C++ ndarray objects
+  // Make numpy array sharing data with ndarray<T, Rank> or ndarray<const T, Rank>
+  // pointed by vdata, non-const ndarrays produce writable numpy arrays.
   template <typename T, unsigned Rank>
-  class NdarrayWrapper : public pytools::PyDataType<NdarrayWrapper<T, Rank>, ndarray<const T, Rank> > {
-  public:
-
-    typedef pytools::PyDataType<NdarrayWrapper, ndarray<const T, Rank> > BaseType;
-
-    /// Initialize Python type and register it in a module
-    static void initType( PyObject* module ) {
+  PyObject* toNumpy(const boost::shared_ptr<void>& vdata, bool isConst)
+  {
+    typedef ndarray<T, Rank> ArrType;
+    typedef ndarray<const T, Rank> ConstArrType;
 
-      static char typedoc[] = "Special Python type which wraps C++ ndarray. "
-          "The instances of this type are not used directly, but the type itself is used as "
-          "an argument for Event.get() method.";
+    // non-const ndarray is converted to const, they share the same data
+    const ConstArrType arr = isConst ? *boost::static_pointer_cast<ConstArrType>(vdata)
+                                     : ConstArrType(*boost::static_pointer_cast<ArrType>(vdata));
 
-      static std::string name = std::string("ndarray_") + Traits<T>::typeName() + "_" + boost::lexical_cast<std::string>(Rank);
+    // item size
+    const size_t itemsize = sizeof(T);
 
-      PyTypeObject* type = BaseType::typeObject() ;
-      type->tp_doc = typedoc;
+    // NumPy type number
+    const int typenum = psana_python::NdarrayTraits<T>::numpyType();
 
-      BaseType::initType(name.c_str(), module, "psana");
+    // dimensions and strides, numpy strides are in bytes
+    npy_intp dims[Rank], strides[Rank];
+    std::copy(arr.shape(), arr.shape()+Rank, dims);
+    for (unsigned i = 0; i != Rank; ++ i) {
+      strides[i] = arr.strides()[i] * itemsize;
     }
 
-    // Dump object info to a stream
-    void print(std::ostream& out) const {
-      out << this->m_obj;
+    // set all flags
+    int flags = 0;
+    if (not isConst) {
+      flags |= NPY_WRITEABLE;
+    }
+    if (psana_python::isCArray<Rank>(arr.shape(), arr.strides())) {
+      flags |= NPY_C_CONTIGUOUS;
+    }
+    if (reinterpret_cast<size_t>(arr.data()) % itemsize == 0) {
+      flags |= NPY_ALIGNED;
     }
 
+    // now make an instance of numpy.ndarray
+    PyObject* array = PyArray_New(&PyArray_Type, Rank, dims, typenum, strides,
+                                  (void*)(arr.data()), itemsize, flags, 0);
+
+    // array does not own its data, create an instance which handles lifetime of the array
+    PyArrayObject* oarray = (PyArrayObject*)array;
+    oarray->base = psana_python::NdarrayWrapper<T, Rank>::wrap(arr);
+
+    psana_python::ConverterStats::count(psana_python::ConverterStats::ToNumpy, typenum,
+                                        psana_python::NdarrayTraits<T>::typeName(), Rank, arr.size() * itemsize);
+
+    return array;
+  }
+
+  // Table of all supported types, order defines which type is returned
+  // when objects of several types are stored with the same key
+#define ND_ENTRY(r, PRODUCT) \
+  { psana_python::NdarrayTraits<BOOST_PP_SEQ_ELEM(0, PRODUCT)>::typeName(), BOOST_PP_SEQ_ELEM(1, PRODUCT), \
+    &typeid(ndarray<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)>), \
+    &typeid(ndarray<const BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)>), \
+    &psana_python::NdarrayWrapper<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)>::readyType, \
+    &toNumpy<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)> },
+
+  const NdarrayCvt::Entry entries[] = {
+    BOOST_PP_SEQ_FOR_EACH_PRODUCT(ND_ENTRY, (PSANA_PYTHON_ND_TYPES)(PSANA_PYTHON_ND_RANKS))
+  };
+
+#undef ND_ENTRY
+
+  const unsigned numEntries = sizeof entries / sizeof entries[0];
+
+  // Ordering of type_info pointers, pointers themselves may differ between libraries
+  struct TypeInfoLess {
+    bool operator()(const std::type_info* lhs, const std::type_info* rhs) const {
+      return lhs->before(*rhs);
+    }
   };
 
-  // REturns true if strides correspond to C memmory layout
-  template <unsigned Rank>
-  bool isCArray(const unsigned shape[], const int strides[]) {
-    int stride = 1;
-    for (int i = Rank; i > 0; -- i) {
-      if (strides[i-1] != stride) return false;
-      stride *= shape[i-1];
+  // Maps C++ type of ndarray to (index in table, const flag)
+  typedef std::map<const std::type_info*, std::pair<unsigned, bool>, TypeInfoLess> TypeIndex;
+
+  TypeIndex makeTypeIndex()
+  {
+    TypeIndex index;
+    for (unsigned i = 0; i != numEntries; ++ i) {
+      index.insert(std::make_pair(entries[i].type, std::make_pair(i, false)));
+      index.insert(std::make_pair(entries[i].constType, std::make_pair(i, true)));
     }
-    return true;
+    return index;
+  }
+
+  const TypeIndex& typeIndex()
+  {
+    static TypeIndex index = makeTypeIndex();
+    return index;
   }
 
-  template<typename T, unsigned Rank>
-  std::string BothConstAndNonConstNdarrayMsg(const PSEvt::Source &source, 
+  std::string BothConstAndNonConstNdarrayMsg(const NdarrayCvt::Entry& entry,
+                                             const PSEvt::Source &source,
                                              const std::string &key) {
     std::ostringstream msg;
     msg << "Both const and non-const element type found for ndarray<"
-          << Traits<T>::typeName() << "," << Rank << "> for event key with source=" 
-          << source << " and key=" << key 
+          << entry.typeName << "," << entry.rank << "> for event key with source="
+          << source << " and key=" << key
           << " convert is ambiguous. Use key string to distingish.";
     return msg.str();
   }
 
+  // Convert ndarray described by table entry, return 0 if there is no such object.
+  // Ndarray with constness given by isConst is looked for first, on return
+  // isConst is set to the constness of found object. Ambiguity check looks
+  // for the other type with the exact source of found object, it does not
+  // make proxies produce the data.
+  PyObject* convertEntry(const NdarrayCvt::Entry& entry, PSEvt::ProxyDictI& proxyDict,
+                         const PSEvt::Source& source, const std::string& key, bool& isConst)
+  {
+    const std::type_info* types[2] = { entry.type, entry.constType };
+
+    Pds::Src foundSrc;
+    boost::shared_ptr<void> vdata = proxyDict.get(types[isConst], source, key, &foundSrc);
+    if (vdata) {
+      if (proxyDict.exists(PSEvt::EventKey(types[not isConst], foundSrc, key))) {
+        throw std::runtime_error(BothConstAndNonConstNdarrayMsg(entry, source, key));
+      }
+    } else {
+      // other type does not exist for any matching source, no ambiguity is possible
+      isConst = not isConst;
+      vdata = proxyDict.get(types[isConst], source, key, 0);
+      if (not vdata) return 0;
+    }
+
+    return entry.toNumpy(vdata, isConst);
+  }
+
 }
 
 
@@ -155,146 +207,124 @@ namespace psana_python {
 //----------------
 // Constructors --
 //----------------
-template <typename T, unsigned Rank>
-NdarrayCvt<T, Rank>::NdarrayCvt (PyObject* module)
+NdarrayCvt::NdarrayCvt ()
+  : Converter()
+  , m_entry(0)
+{
+}
+
+NdarrayCvt::NdarrayCvt (const Entry* entry)
   : Converter()
+  , m_entry(entry)
 {
 }
 
 //--------------
 // Destructor --
 //--------------
-template <typename T, unsigned Rank>
-NdarrayCvt<T, Rank>::~NdarrayCvt ()
+NdarrayCvt::~NdarrayCvt ()
 {
 }
 
 /// Return type_info of the corresponding C++ type.
-template <typename T, unsigned Rank>
 std::vector<const std::type_info*>
-NdarrayCvt<T, Rank>::from_cpp_types() const
+NdarrayCvt::from_cpp_types() const
 {
-  const std::type_info *types[2] = {&typeid(ndarray<T, Rank>), 
-                                    &typeid(ndarray<const T, Rank>)};
-  return std::vector<const std::type_info*>(types,types+2);
+  std::vector<const std::type_info*> res;
+  if (m_entry) {
+    res.push_back(m_entry->type);
+    res.push_back(m_entry->constType);
+  } else {
+    for (unsigned i = 0; i != numEntries; ++ i) {
+      res.push_back(entries[i].type);
+      res.push_back(entries[i].constType);
+    }
+  }
+  return res;
 }
 
 /// Returns source Python types.
-template <typename T, unsigned Rank>
 std::vector<PyTypeObject*>
-NdarrayCvt<T, Rank>::from_py_types() const
+NdarrayCvt::from_py_types() const
 {
   // we accept numpy.ndarray as input
   return std::vector<PyTypeObject*>();
 }
 
 /// Returns destination Python types.
-template <typename T, unsigned Rank>
 std::vector<PyTypeObject*>
-NdarrayCvt<T, Rank>::to_py_types() const
+NdarrayCvt::to_py_types() const
 {
   std::vector<PyTypeObject*> res;
-  res.push_back(NdarrayWrapper<T, Rank>::typeObject());
-  res.push_back(&PyArray_Type);
+  if (m_entry) {
+    res.push_back(m_entry->wrapperType());
+  } else {
+    res.push_back(&PyArray_Type);
+  }
   return res;
 }
 
 
 /// Convert C++ object to Python
-template <typename T, unsigned Rank>
 PyObject*
-NdarrayCvt<T, Rank>::convert(PSEvt::ProxyDictI& proxyDict, const PSEvt::Source& source, const std::string& key) const
+NdarrayCvt::convert(PSEvt::ProxyDictI& proxyDict, const PSEvt::Source& source, const std::string& key) const
 {
-  typedef ndarray<T, Rank> ArrType;
-  typedef ndarray<const T, Rank> ConstArrType;
-
-  // item size
-  const size_t itemsize = sizeof(T);
-
-  // NumPy type number
-  const int typenum = Traits<T>::numpyType();
-
-  // dimensions and strides, numpy strides are in bytes
-  npy_intp dims[Rank], strides[Rank];
-
-  void* data = 0;
-  int flags = 0;
-  PyObject* base = 0;
-
-  if (boost::shared_ptr<void> vdata = proxyDict.get(&typeid(ArrType), source, key, 0)) {
-    if (proxyDict.get(&typeid(ConstArrType), source, key, 0)) {
-      throw std::runtime_error(BothConstAndNonConstNdarrayMsg<T,Rank>(source, key));
-    }
-    const ArrType& arr = *boost::static_pointer_cast<ArrType>(vdata);
-
-    std::copy(arr.shape(), arr.shape()+Rank, dims);
-    for (unsigned i = 0; i != Rank; ++ i) {
-      strides[i] = arr.strides()[i] * itemsize;
-    }
-
-    // set all flags
-    flags |= NPY_WRITEABLE;
-    if (::isCArray<Rank>(arr.shape(), arr.strides())) {
-      flags |= NPY_C_CONTIGUOUS;
-    }
-    if (reinterpret_cast<size_t>(arr.data()) % itemsize == 0) {
-      flags |= NPY_ALIGNED;
-    }
-
-    data = (void*)(arr.data());
-    base = NdarrayWrapper<T, Rank>::PyObject_FromCpp(ConstArrType(arr));
-
-  } else if (boost::shared_ptr<void> vdata = proxyDict.get(&typeid(ConstArrType), source, key, 0)) {
-    if (proxyDict.get(&typeid(ArrType), source, key, 0)) {
-      throw std::runtime_error(BothConstAndNonConstNdarrayMsg<T,Rank>(source, key));
-    }
-
-    const ConstArrType& arr = *boost::static_pointer_cast<ConstArrType>(vdata);
-
-    std::copy(arr.shape(), arr.shape()+Rank, dims);
-    for (unsigned i = 0; i != Rank; ++ i) {
-      strides[i] = arr.strides()[i] * itemsize;
-    }
+  if (m_entry) {
+    bool isConst = false;
+    return ::convertEntry(*m_entry, proxyDict, source, key, isConst);
+  }
 
-    // set all flags
-    if (::isCArray<Rank>(arr.shape(), arr.strides())) {
-      flags |= NPY_C_CONTIGUOUS;
-    }
-    if (reinterpret_cast<size_t>(arr.data()) % itemsize == 0) {
-      flags |= NPY_ALIGNED;
+  // Instead of trying every supported type look at the keys which exist
+  // for this source and find first table entry which matches any of them
+  std::list<PSEvt::EventKey> keys;
+  proxyDict.keys(keys, source);
+
+  const TypeIndex& index = ::typeIndex();
+  unsigned first = numEntries;
+  bool isConst = false;
+  for (std::list<PSEvt::EventKey>::const_iterator it = keys.begin(); it != keys.end(); ++ it) {
+    if (it->key() != key or not it->typeinfo()) continue;
+    TypeIndex::const_iterator iit = index.find(it->typeinfo());
+    if (iit != index.end() and iit->second.first < first) {
+      first = iit->second.first;
+      isConst = iit->second.second;
     }
-
-    data = (void*)(arr.data());
-    base = NdarrayWrapper<T, Rank>::PyObject_FromCpp(arr);
-
-  } else {
-
-    return 0;
-
   }
+  if (first == numEntries) return 0;
 
-  // now make an instance of numpy.ndarray
-  PyObject* array = PyArray_New(&PyArray_Type, Rank, dims, typenum, strides,
-                                data, itemsize, flags, 0);
-
-  // array does not own its data, create an instance which handles lifetime of the array
-  PyArrayObject* oarray = (PyArrayObject*)array;
-  oarray->base = base;
+  MsgLog(logger, debug, "NdarrayCvt: dispatching to ndarray<" << entries[first].typeName
+         << "," << entries[first].rank << "> for key '" << key << "'");
 
-  return array;
+  // constness is known from the keys, look for that type first
+  return ::convertEntry(entries[first], proxyDict, source, key, isConst);
 }
 
 /*
- *  Method that registers converters for all supported types, this will also
- *  create all necessary data types.
+ *  Method that registers converters for all supported types and adds
+ *  wrapper types to a module.
  */
 void initNdarrayCvt(psddl_python::ConverterMap& cmap, PyObject* module)
 {
-#define INST_CVT(r, PRODUCT) \
-  ::NdarrayWrapper<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)>::initType(module); \
-  cmap.addConverter(boost::make_shared<NdarrayCvt<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)> >(module));
+  g_module = module;
+
+  // all wrapper types must be in module when it is imported so that
+  // "from _psana import *" sees them
+  for (unsigned i = 0; i != numEntries; ++ i) {
+    entries[i].wrapperType();
+  }
+
+  // converters for wrapper types go first so that EventKey.type() returns
+  // wrapper type and not numpy.ndarray
+  for (unsigned i = 0; i != numEntries; ++ i) {
+    cmap.addConverter(boost::make_shared<NdarrayCvt>(&entries[i]));
+  }
+  cmap.addConverter(boost::make_shared<NdarrayCvt>());
+}
 
-  BOOST_PP_SEQ_FOR_EACH_PRODUCT(INST_CVT, (ND_TYPES)(ND_RANKS))
+PyObject*
+ndarrayWrapperModule()
+{
+  return g_module;
 }
 
 } // namespace psana_python
@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class NdarrayKeepTest...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/NdarrayKeepTest.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <sstream>
+#include <boost/make_shared.hpp>
+#include <boost/python.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psana_python/GILReleaser.h"
+#include "PSEvt/Event.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+// This declares this class as psana module
+using namespace psana_python;
+PSANA_MODULE_FACTORY(NdarrayKeepTest)
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+NdarrayKeepTest::NdarrayKeepTest (const std::string& name)
+  : psana::Module(name)
+  , m_count(0)
+  , m_kept()
+  , m_weakref(0)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+NdarrayKeepTest::~NdarrayKeepTest ()
+{
+  // nothing to release if interpreter is already gone
+  if (not Py_IsInitialized()) return;
+  GILLocker gil;
+  Py_CLEAR(m_weakref);
+}
+
+/// Method which is called with event data
+void
+NdarrayKeepTest::event(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  ++ m_count;
+
+  if (m_count == 1) {
+    // numpy array is only referenced by the converted ndarray after this block
+    GILLocker gil;
+    boost::python::object arr = boost::python::import("numpy").attr("arange")(3.);
+    m_weakref = PyWeakref_NewRef(arr.ptr(), 0);
+    m_kept = boost::python::extract<ndarray<const double, 1> >(arr);
+  } else if (m_count == 3) {
+    // last reference is dropped here, module may run with GIL released
+    m_kept = ndarray<const double, 1>();
+  }
+
+  GILLocker gil;
+  std::ostringstream str;
+  str << "alive=" << int(m_weakref and PyWeakref_GET_OBJECT(m_weakref) != Py_None);
+  if (m_kept.data()) {
+    str << " values=";
+    for (unsigned i = 0; i != m_kept.size(); ++ i) str << (i ? " " : "") << m_kept[i];
+  }
+  evt.put(boost::make_shared<std::string>(str.str()), "ndarray_keep_test");
+}
+
+} // namespace psana_python
@@ -0,0 +1,137 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class ObjectLock...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/ObjectLock.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <map>
+#include <new>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  // mutex of one object
+  struct Entry {
+    PyThread_type_lock lock;
+    unsigned long owner;  // thread which holds the mutex, zero if none
+    unsigned depth;       // lock depth for owner thread
+    unsigned users;       // number of ObjectLock instances using this entry
+    const void* obj;      // key in the map
+    int domain;
+  };
+
+  typedef std::map<std::pair<int, const void*>, Entry*> EntryMap;
+
+  // mutexes of all currently locked objects, map mutex is never held
+  // while waiting for object mutex or GIL
+  boost::mutex g_entriesMutex;
+  EntryMap g_entries;
+
+  Entry* acquireEntry(const void* obj, int domain)
+  {
+    boost::mutex::scoped_lock lock(g_entriesMutex);
+    Entry*& entry = g_entries[std::make_pair(domain, obj)];
+    if (not entry) {
+      entry = new Entry();
+      entry->lock = PyThread_allocate_lock();
+      entry->obj = obj;
+      entry->domain = domain;
+      if (not entry->lock) {
+        g_entries.erase(std::make_pair(domain, obj));
+        throw std::bad_alloc();
+      }
+    }
+    ++ entry->users;
+    return entry;
+  }
+
+  void releaseEntry(Entry* entry)
+  {
+    boost::mutex::scoped_lock lock(g_entriesMutex);
+    if (-- entry->users == 0) {
+      g_entries.erase(std::make_pair(entry->domain, entry->obj));
+      PyThread_free_lock(entry->lock);
+      delete entry;
+    }
+  }
+
+  // true if calling thread holds GIL
+  bool gilHeld()
+  {
+#if PY_VERSION_HEX >= 0x03040000
+    return PyGILState_Check();
+#else
+    PyThreadState* tstate = PyGILState_GetThisThreadState();
+    return tstate and tstate == _PyThreadState_Current;
+#endif
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+ObjectLock::ObjectLock(const void* obj, Domain domain)
+  : m_entry(::acquireEntry(obj, domain))
+{
+  Entry* entry = static_cast<Entry*>(m_entry);
+  const unsigned long self = PyThread_get_thread_ident();
+  if (__atomic_load_n(&entry->owner, __ATOMIC_RELAXED) == self) {
+    ++ entry->depth;
+    return;
+  }
+
+  if (not PyThread_acquire_lock(entry->lock, NOWAIT_LOCK)) {
+    // mutex owner may need GIL to finish, do not wait with GIL held
+    if (::gilHeld()) {
+      PyThreadState* tstate = PyEval_SaveThread();
+      PyThread_acquire_lock(entry->lock, WAIT_LOCK);
+      PyEval_RestoreThread(tstate);
+    } else {
+      PyThread_acquire_lock(entry->lock, WAIT_LOCK);
+    }
+  }
+  __atomic_store_n(&entry->owner, self, __ATOMIC_RELAXED);
+  entry->depth = 1;
+}
+
+//--------------
+// Destructor --
+//--------------
+ObjectLock::~ObjectLock()
+{
+  Entry* entry = static_cast<Entry*>(m_entry);
+  if (-- entry->depth == 0) {
+    __atomic_store_n(&entry->owner, 0UL, __ATOMIC_RELAXED);
+    PyThread_release_lock(entry->lock);
+  }
+  ::releaseEntry(entry);
+}
+
+} // namespace psana_python
@@ -31,6 +31,8 @@
 //-------------------------------
 #include "pdsdata/xtc/TypeId.hh"
 #include "psana_python/EventKey.h"
+#include "psana_python/Ndarray2CppCvt.h"
+#include "psana_python/ObjectLock.h"
 #include "psana_python/PdsSrc.h"
 #include "psddl_python/ConverterMap.h"
 #include "PSEvt/DataProxy.h"
@@ -44,6 +46,41 @@
 using psddl_python::ConverterMap;
 using psddl_python::Converter;
 
+namespace {
+
+  // Lookups in ConverterMap return copies of converter lists, the map can be
+  // updated by other threads so lookups are locked
+  ConverterMap::CvtList toPyConverters(PyTypeObject* pytype)
+  {
+    ConverterMap& cmap = ConverterMap::instance();
+    psana_python::ObjectLock lock(&cmap, psana_python::ObjectLock::Converters);
+    return cmap.getToPyConverters(pytype);
+  }
+
+  ConverterMap::CvtList fromPyConverters(PyTypeObject* pytype)
+  {
+    ConverterMap& cmap = ConverterMap::instance();
+    psana_python::ObjectLock lock(&cmap, psana_python::ObjectLock::Converters);
+    return cmap.getFromPyConverters(pytype);
+  }
+
+  ConverterMap::CvtList fromPdsConverters(int pdsTypeId)
+  {
+    ConverterMap& cmap = ConverterMap::instance();
+    psana_python::ObjectLock lock(&cmap, psana_python::ObjectLock::Converters);
+    return cmap.getFromPdsConverters(pdsTypeId);
+  }
+
+  // C++ type of ndarray stored in event together with Python object,
+  // zero if object is not converted, byte strings are not converted
+  const std::type_info* bufferArrayType(PyObject* obj)
+  {
+    if (PyBytes_Check(obj) or PyByteArray_Check(obj)) return 0;
+    return psana_python::Ndarray2CppCvt::bufferArrayType(obj);
+  }
+
+}
+
 //		----------------------------------------
 // 		-- Public Function Member Definitions --
 //		----------------------------------------
@@ -53,6 +90,9 @@ namespace psana_python {
 PyObject*
 ProxyDictMethods::keys(PSEvt::ProxyDictI& proxyDict, PyObject* args)
 {
+  // serialize access to dictionary, event can be shared with GIL-free code
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   // parse arguments
   PSEvt::Source src;
   PyObject* obj = 0;
@@ -179,6 +219,8 @@ ProxyDictMethods::arg_get_put(PyObject* args, bool needExact, const PSEvt::Alias
 PyObject*
 ProxyDictMethods::get_compat_string(PSEvt::ProxyDictI& proxyDict, PyObject* arg0)
 {
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   /*
    *  pyana compatibility method (deprecated):
    *  get(string)            - gets any Python object stored with put(object, string)
@@ -200,6 +242,8 @@ ProxyDictMethods::get_compat_string(PSEvt::ProxyDictI& proxyDict, PyObject* arg0
 PyObject*
 ProxyDictMethods::get_compat_typeid(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, PyObject* arg1)
 {
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   /*
    *  pyana compatibility methods (deprecated):
    *  get(int, addr:string)  - equivalent to get(type, Source(addr), "") where type is deduced
@@ -240,8 +284,7 @@ ProxyDictMethods::get_compat_typeid(PSEvt::ProxyDictI& proxyDict, PyObject* arg0
     }
   }
 
-  ConverterMap& cmap = ConverterMap::instance();
-  BOOST_FOREACH(boost::shared_ptr<Converter> cvt, cmap.getFromPdsConverters(pdsTypeId)) {
+  BOOST_FOREACH(boost::shared_ptr<Converter> cvt, ::fromPdsConverters(pdsTypeId)) {
     if (PyObject* obj = cvt->convert(proxyDict, source, std::string())) return obj;
   }
 
@@ -251,6 +294,8 @@ ProxyDictMethods::get_compat_typeid(PSEvt::ProxyDictI& proxyDict, PyObject* arg0
 PyObject*
 ProxyDictMethods::get(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const PSEvt::Source& source, const std::string& key)
 {
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   /*
    *  get(...) is very overloaded method, here is the list of possible argument combinations:
    *  get(type, src, key:string)
@@ -268,11 +313,10 @@ ProxyDictMethods::get(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const PSEvt:
   if (types.empty()) return 0;
 
   // loop over types and find first matching object
-  ConverterMap& cmap = ConverterMap::instance();
   BOOST_FOREACH(pytools::pyshared_ptr type_ptr, types) {
     // get converters defined for this Python type
     PyTypeObject* pytype = (PyTypeObject*)type_ptr.get();
-    std::vector<boost::shared_ptr<Converter> > converters = cmap.getToPyConverters(pytype);
+    std::vector<boost::shared_ptr<Converter> > converters = ::toPyConverters(pytype);
     if (not converters.empty()) {
       // there are converters registered for this type, try all of them
       BOOST_FOREACH(boost::shared_ptr<Converter> cvt, converters) {
@@ -300,12 +344,13 @@ ProxyDictMethods::get(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const PSEvt:
 PyObject*
 ProxyDictMethods::put(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const Pds::Src& source, const std::string& key)
 {
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   // get type of python object
   PyTypeObject* pytype = arg0->ob_type;
 
   // get converters defined for this Python type
-  ConverterMap& cmap = ConverterMap::instance();
-  std::vector<boost::shared_ptr<Converter> > converters = cmap.getFromPyConverters(pytype);
+  std::vector<boost::shared_ptr<Converter> > converters = ::fromPyConverters(pytype);
   if (not converters.empty()) {
 
     // there are converters registered for this type, try all of them
@@ -323,19 +368,36 @@ ProxyDictMethods::put(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const Pds::S
 
   } else {
 
-    // no converters, store it as Python object, for compatibility we allow
-    // replacement of the objects
-    pytools::pyshared_ptr optr = pytools::make_pyshared(arg0, false);
-    boost::shared_ptr<PSEvt::ProxyI> proxyPtr(boost::make_shared<PSEvt::DataProxy<PyObject> >(optr));
+    // objects exporting buffer protocol (memoryview, array.array, arrays
+    // from other libraries) are also stored as ndarrays which share their
+    // data so that C++ can use them, Python object itself is still stored
+    // below so that get(key) returns it, byte strings are not converted
+    const std::type_info* arrayType = ::bufferArrayType(arg0);
+
+    // for compatibility we allow replacement of Python objects, ndarray made
+    // from replaced object is replaced together with it
     PSEvt::EventKey evKey(&typeid(const PyObject), source, key);
-    try {
-      proxyDict.put(proxyPtr, evKey);
-    } catch (const PSEvt::ExceptionDuplicateKey& e) {
-      // on Python side we allow replacing existing objects
-      proxyDict.remove(evKey);
-      proxyDict.put(proxyPtr, evKey);
+    const PSEvt::Source exact = source == PSEvt::EventKey::noSource() ?
+        PSEvt::Source(PSEvt::Source::null) : PSEvt::Source(source);
+    boost::shared_ptr<void> old = proxyDict.get(&typeid(const PyObject), exact, key, 0);
+    const std::type_info* oldArrayType = old ? ::bufferArrayType((PyObject*)old.get()) : 0;
+
+    // ndarray which was not made from replaced object belongs to C++
+    if (arrayType and not (oldArrayType and *oldArrayType == *arrayType) and
+        proxyDict.exists(PSEvt::EventKey(arrayType, source, key))) {
+      PyErr_SetString(PyExc_ValueError, "Cannot replace objects visible to C++");
+      return 0;
     }
 
+    if (oldArrayType) proxyDict.remove(PSEvt::EventKey(oldArrayType, source, key));
+    if (old) proxyDict.remove(evKey);
+
+    if (arrayType) Ndarray2CppCvt::convertBuffer(arg0, proxyDict, source, key);
+
+    pytools::pyshared_ptr optr = pytools::make_pyshared(arg0, false);
+    boost::shared_ptr<PSEvt::ProxyI> proxyPtr(boost::make_shared<PSEvt::DataProxy<PyObject> >(optr));
+    proxyDict.put(proxyPtr, evKey);
+
   }
 
   Py_RETURN_NONE;
@@ -348,6 +410,8 @@ ProxyDictMethods::put(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const Pds::S
 PyObject*
 ProxyDictMethods::remove(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const Pds::Src& source, const std::string& key)
 {
+  ObjectLock lock(&proxyDict, ObjectLock::ProxyDict);
+
   // first argument is a type or list of types like in get()
   const std::vector<pytools::pyshared_ptr>& types = get_types(arg0, "remove");
   if (types.empty()) return 0;
@@ -355,12 +419,11 @@ ProxyDictMethods::remove(PSEvt::ProxyDictI& proxyDict, PyObject* arg0, const Pds
   bool result = false;
 
   // loop over types and find first matching object
-  ConverterMap& cmap = ConverterMap::instance();
   BOOST_FOREACH(pytools::pyshared_ptr type_ptr, types) {
 
     // get converters defined for this Python type
     PyTypeObject* pytype = (PyTypeObject*)type_ptr.get();
-    std::vector<boost::shared_ptr<Converter> > converters = cmap.getToPyConverters(pytype);
+    std::vector<boost::shared_ptr<Converter> > converters = ::toPyConverters(pytype);
     if (not converters.empty()) {
 
       // there are converters registered for this type, try all of them
@@ -23,20 +23,34 @@
 // C/C++ Headers --
 //-----------------
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
 #include <boost/python.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
 #include "MsgLogger/MsgLogger.h"
+#include "PSEvt/Event.h"
 #include "PSEvt/EventId.h"
 #include "psana_python/Exceptions.h"
+#include "psana_python/GILReleaser.h"
+#include "psana_python/ObjectLock.h"
 #include "psana_python/Env.h"
 #include "psana_python/Event.h"
 #include "psana_python/Source.h"
+#include "psana_python/StartupTrace.h"
+#include "psddl_python/psddl_python_numpy.h"
 #include "pytools/PyUtil.h"
 
 //-----------------------------------------------------------------------
@@ -71,9 +85,42 @@ namespace {
     return msg;
   }
 
+  // true for Python string objects
+  bool isString(PyObject* obj)
+  {
+#ifdef IS_PY3K
+    return PyUnicode_Check(obj) or PyBytes_Check(obj);
+#else
+    return PyString_Check(obj);
+#endif
+  }
+
+  // parse one item of produces/consumes attribute, returns false if it
+  // has unexpected format; text of declaration is filled in any case
+  bool parseDeclaration(PyObject* item, psana_python::PythonModule::DataDeclaration& decl);
+
   // initialization of interpreter
   bool py_init();
 
+  // import of all configured modules when psana.warm_import is set
+  bool warm_import();
+
+  // Python modules of each psana context (framework instance), needed to
+  // find which modules in the chain are Python modules; several frameworks
+  // may exist in one process, each with its own configuration and modules.
+  // Modules made by psana loader are kept with the name which loader passed
+  // to moduleFactory(), modules added through DataSource follow configured
+  // modules in the order of addition.
+  struct Chain {
+    Chain() : generation(0) {}
+    std::multiset<std::string> loaded;
+    std::vector<const psana_python::PythonModule*> added;
+    unsigned long generation;  // changes when modules are added or removed
+  };
+  typedef std::map<psana::Context::context_t, Chain> Chains;
+  boost::mutex g_chainsMutex;
+  Chains g_chains;
+
   // names for psana-style methods, this must correspond to method enums in class declaration
   const char* psana_methods[] = {
     "beginJob", "beginRun", "beginCalibCycle", "event", "endCalibCycle", "endRun", "endJob"
@@ -98,6 +145,13 @@ namespace {
     }
   }
 
+  // convert string value of config parameter to Python object, new reference
+  PyObject* configValue(const std::string& str);
+
+  // true if word is a decimal floating point number with a fraction or an
+  // exponent, e.g. "1.", "-.5" or "2e10", but not "nan", "inf" or "0x1p3"
+  bool isPlainFloat(const std::string& word);
+
   // extra methods definition
   psana_python::PythonModule* cpp_module(PyObject* self);
   PyObject* extra_name(PyObject* self, PyObject* args);
@@ -112,6 +166,27 @@ namespace {
   PyObject* extra_configListFloat(PyObject* self, PyObject* args);
   PyObject* extra_configListStr(PyObject* self, PyObject* args);
   PyObject* extra_configListSrc(PyObject* self, PyObject* args);
+
+  // Calls one of the config accessors above caching its result. Returns cached
+  // object or a copy of cached list, the result is the same for the same args.
+  PyObject* configCached(PyObject* self, const char* method, PyObject* args, PyCFunction func);
+
+#define CACHED_CONFIG(METHOD) \
+  PyObject* cached_##METHOD(PyObject* self, PyObject* args) { return configCached(self, #METHOD, args, extra_##METHOD); }
+
+  CACHED_CONFIG(configBool)
+  CACHED_CONFIG(configInt)
+  CACHED_CONFIG(configFloat)
+  CACHED_CONFIG(configStr)
+  CACHED_CONFIG(configSrc)
+  CACHED_CONFIG(configListBool)
+  CACHED_CONFIG(configListInt)
+  CACHED_CONFIG(configListFloat)
+  CACHED_CONFIG(configListStr)
+  CACHED_CONFIG(configListSrc)
+
+#undef CACHED_CONFIG
+
   PyObject* extra_skip(PyObject* self, PyObject* args);
   PyObject* extra_stop(PyObject* self, PyObject* args);
   PyObject* extra_terminate(PyObject* self, PyObject* args);
@@ -119,29 +194,29 @@ namespace {
   static PyMethodDef extraMethods[] = {
     {"name",        extra_name,          METH_NOARGS,  "self.name() -> str\n\nReturns the name of this module"},
     {"className",   extra_className,     METH_NOARGS,  "self.className() -> str\n\nReturns class name of this module"},
-    {"configBool",  extra_configBool,    METH_VARARGS,
+    {"configBool",  cached_configBool,    METH_VARARGS,
         "self.configBool(param:str[, default:bool]) -> bool\n\nReturns value of boolean parameter"},
-    {"configInt",   extra_configInt,     METH_VARARGS,
+    {"configInt",   cached_configInt,     METH_VARARGS,
         "self.configInt(param:str[, default:int]) -> int\n\nReturns value of integer parameter"},
-    {"configFloat", extra_configFloat,   METH_VARARGS,
+    {"configFloat", cached_configFloat,   METH_VARARGS,
         "self.configFloat(param:str[, default:float]) -> float\n\nReturns value of floating point parameter"},
-    {"configStr",   extra_configStr,     METH_VARARGS,
+    {"configStr",   cached_configStr,     METH_VARARGS,
         "self.configStr(param:str[, default:str]) -> str\n\nReturns string value of parameter"},
-    {"configSrc",   extra_configSrc,     METH_VARARGS,
+    {"configSrc",   cached_configSrc,     METH_VARARGS,
         "self.configSrc(param:str[, default:str]) -> Source\n\nReturns value of parameter as a Source object"},
-    {"configListBool",  extra_configListBool,     METH_O,
+    {"configListBool",  cached_configListBool,     METH_O,
         "self.configListBool(param:str) -> list of bool\n\nReturns value of parameter as a list of booleans, "
         "if parameter is not defined then empty list is returned."},
-    {"configListInt",   extra_configListInt,     METH_O,
+    {"configListInt",   cached_configListInt,     METH_O,
         "self.configListInt(param:str) -> list of int\n\nReturns value of parameter as a list of integer numbers, "
         "if parameter is not defined then empty list is returned."},
-    {"configListFloat",   extra_configListFloat, METH_O,
+    {"configListFloat",   cached_configListFloat, METH_O,
         "self.configListFloat(param:str) -> list of float\n\nReturns value of parameter as a list of floating numbers, "
         "if parameter is not defined then empty list is returned."},
-    {"configListStr",   extra_configListStr,     METH_O,
+    {"configListStr",   cached_configListStr,     METH_O,
         "self.configListStr(param:str) -> list of str\n\nReturns value of parameter as a list of strings, "
         "if parameter is not defined then empty list is returned."},
-    {"configListSrc",   extra_configListSrc,     METH_O,
+    {"configListSrc",   cached_configListSrc,     METH_O,
         "self.configListSrc(param:str) -> list of Source\n\nReturns value of parameter as a list of Source objects, "
         "if parameter is not defined then empty list is returned."},
     {"skip",        extra_skip,          METH_NOARGS,  "self.skip()\n\n"
@@ -175,9 +250,24 @@ PythonModule::PythonModule(const std::string& name, PyObject* instance)
   : Module(name)
   , m_instance(pytools::make_pyshared(instance, false))
   , m_pyanaCompat(true)
+  , m_context(psana::Context::get())
+  , m_loaderName()
+  , m_inChain(false)
+  , m_chainModules()
+  , m_chainGeneration(0)
+  , m_chainKnown(false)
+  , m_nextIsPython(false)
+  , m_lastInChain(false)
+  , m_chainBroken(false)
+  , m_checkDeclarations(false)
+  , m_configCache(pytools::make_pyshared(PyDict_New()))
+  , m_inEvent(false)
+  , m_warnConfigInEvent(false)
 {
   // Currently, pyana compatibity is enabled unless 'psana.pyana_compat' config option is set to 0.
   m_pyanaCompat = configSvc().get("psana", "pyana_compat", true);
+  m_warnConfigInEvent = configSvc().get("psana", "warn_config_in_event", false);
+  m_checkDeclarations = configSvc().get("psana", "check_declarations", false);
 
   // check pyana-style methods first
   for (int i = 0; i != NumMethods; ++ i) {
@@ -212,6 +302,12 @@ PythonModule::PythonModule(const std::string& name, PyObject* instance)
     throw Exception(ERR_LOC, "Error: module " + name + " does not define any methods");
   }
 
+  // optional declarations of event data used by module
+  readDeclarations("produces", m_produces);
+  readDeclarations("consumes", m_consumes);
+
+  makeConfigSnapshot();
+
 }
 
 //--------------
@@ -219,16 +315,85 @@ PythonModule::PythonModule(const std::string& name, PyObject* instance)
 //--------------
 PythonModule::~PythonModule ()
 {
+  if (not m_inChain) return;
+
+  boost::mutex::scoped_lock lock(::g_chainsMutex);
+  ::Chains::iterator it = ::g_chains.find(m_context);
+  if (it == ::g_chains.end()) return;
+  ::Chain& chain = it->second;
+  if (m_loaderName.empty()) {
+    chain.added.erase(std::remove(chain.added.begin(), chain.added.end(), this), chain.added.end());
+  } else {
+    std::multiset<std::string>::iterator nit = chain.loaded.find(m_loaderName);
+    if (nit != chain.loaded.end()) chain.loaded.erase(nit);
+  }
+  ++ chain.generation;
+  if (chain.loaded.empty() and chain.added.empty()) ::g_chains.erase(it);
+}
+
+void
+PythonModule::addToChain(const std::string& loaderName)
+{
+  if (m_inChain) return;
+  m_inChain = true;
+  m_loaderName = loaderName;
+
+  boost::mutex::scoped_lock lock(::g_chainsMutex);
+  ::Chain& chain = ::g_chains[m_context];
+  if (loaderName.empty()) {
+    chain.added.push_back(this);
+  } else {
+    chain.loaded.insert(loaderName);
+  }
+  ++ chain.generation;
 }
 
 void
-PythonModule::call(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env)
+PythonModule::call(int meth, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env)
 {
-  if (not method) return;
+  PyObject* method = m_methods[meth].get();
+
+  if (not GILReleaser::active()) {
+
+    if (not method) return;
+
+    // ensuer GIL is locked, restore when lock goes out of scope
+    GILLocker lock;
 
-  // ensuer GIL is locked, restore when lock goes out of scope
-  GILLocker lock;
+    invoke(method, pyana_optional_evt, evt, env);
 
+  } else {
+
+    // Framework runs on a Python thread which released GIL (e.g. inside
+    // event iterator), take it back only once for a sequence of Python
+    // modules and release it when next module is a C++ module.
+
+    findChainPosition();
+
+    // At the end of the event the GIL is kept locked for the iterator
+    // which returns event to Python, it would need to lock it anyway.
+    bool keep = m_nextIsPython or (meth == MethEvent and m_lastInChain);
+
+    if (method) {
+      GILReleaser::acquire();
+      try {
+        invoke(method, pyana_optional_evt, evt, env);
+      } catch (...) {
+        GILReleaser::release();
+        throw;
+      }
+      if (m_chainBroken) keep = false;
+    }
+
+    // GIL could be left locked by preceding module too
+    if (not keep) GILReleaser::release();
+
+  }
+}
+
+void
+PythonModule::invoke(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt, PSEnv::Env& env)
+{
   // in pyana mode some methods can take either (env) or (evt, env),
   // check number of arguments to guess how to call it
   int nargs = 2;
@@ -239,15 +404,22 @@ PythonModule::call(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt,
   }
 
   pytools::pyshared_ptr args = pytools::make_pyshared(PyTuple_New(nargs));
+  PyObject* pyevt = 0;
   if (nargs > 1) {
-    PyObject* pyevt = psana_python::Event::PyObject_FromCpp(evt.shared_from_this());
+    pyevt = psana_python::Event::PyObject_FromCpp(evt.shared_from_this());
     PyTuple_SET_ITEM(args.get(), 0, pyevt);
   }
   PyObject* pyenv = psana_python::Env::PyObject_FromCpp(env.shared_from_this());
   PyTuple_SET_ITEM(args.get(), nargs - 1, pyenv);
   
+  const bool check = m_checkDeclarations and pyevt and method == m_methods[MethEvent].get();
+  if (check) checkDeclarations(m_consumes, evt, pyevt, "input");
+
   // call the method
+  m_chainBroken = false;
+  m_inEvent = method == m_methods[MethEvent].get();
   pytools::pyshared_ptr res = pytools::make_pyshared(PyObject_Call(method, args.get(), NULL));
+  m_inEvent = false;
   if (not res) {
     PyErr_Print();
     throw ExceptionGenericPyError(ERR_LOC, "Python exception raised, check error output for details");
@@ -274,6 +446,186 @@ PythonModule::call(PyObject* method, bool pyana_optional_evt, PSEvt::Event& evt,
       break;
     }
   }
+
+  // module which skipped event is not expected to produce anything
+  if (check and not m_chainBroken) checkDeclarations(m_produces, evt, pyevt, "output");
+}
+
+void
+PythonModule::makeConfigSnapshot()
+{
+  // do not override anything defined by module itself
+  if (PyObject_HasAttrString(m_instance.get(), "config")) {
+    MsgLog(logger, debug, "module " << name() << " defines 'config' attribute, snapshot is not made");
+    return;
+  }
+
+  // parameters can be defined for class name and overridden for module name
+  pytools::pyshared_ptr dict = pytools::make_pyshared(PyDict_New());
+  const char* sections[] = { 0, 0 };
+  const std::string& clsName = className();
+  const std::string& modName = name();
+  sections[0] = clsName.c_str();
+  if (modName != clsName) sections[1] = modName.c_str();
+  for (unsigned i = 0; i != 2 and sections[i]; ++ i) {
+    const std::list<std::string>& keys = configSvc().getKeys(sections[i]);
+    for (std::list<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++ it) {
+      pytools::pyshared_ptr value = pytools::make_pyshared(::configValue(configSvc().getStr(sections[i], *it)));
+      if (not value or PyDict_SetItemString(dict.get(), it->c_str(), value.get()) < 0) {
+        throw ExceptionGenericPyError(ERR_LOC, "failed to convert parameter " + *it + ": " + ::pyExcStr());
+      }
+    }
+  }
+
+  pytools::pyshared_ptr proxy = pytools::make_pyshared(PyDictProxy_New(dict.get()));
+  if (not proxy or PyObject_SetAttrString(m_instance.get(), "config", proxy.get()) < 0) {
+    throw ExceptionGenericPyError(ERR_LOC, "failed to set 'config' attribute: " + ::pyExcStr());
+  }
+}
+
+void
+PythonModule::readDeclarations(const char* attr, std::vector<DataDeclaration>& decls)
+{
+  pytools::pyshared_ptr seq = pytools::make_pyshared(PyObject_GetAttrString(m_instance.get(), attr));
+  if (not seq) {
+    PyErr_Clear();
+    return;
+  }
+
+  // string itself is iterable, but single key is likely a mistake for a sequence
+  std::vector<pytools::pyshared_ptr> items;
+  if (::isString(seq.get())) {
+    items.push_back(seq);
+  } else {
+    pytools::pyshared_ptr iter = pytools::make_pyshared(PyObject_GetIter(seq.get()));
+    if (not iter) {
+      PyErr_Clear();
+      MsgLog(logger, warning, "module " << name() << ": attribute '" << attr << "' is not a sequence, ignored");
+      return;
+    }
+    while (pytools::pyshared_ptr item = pytools::make_pyshared(PyIter_Next(iter.get()))) {
+      items.push_back(item);
+    }
+    if (PyErr_Occurred()) {
+      PyErr_Clear();
+      MsgLog(logger, warning, "module " << name() << ": failed to iterate over '" << attr << "', ignored");
+      return;
+    }
+  }
+
+  for (std::vector<pytools::pyshared_ptr>::const_iterator it = items.begin(); it != items.end(); ++ it) {
+    DataDeclaration decl;
+    decl.warned = false;
+    if (::parseDeclaration(it->get(), decl)) {
+      decls.push_back(decl);
+    } else {
+      MsgLog(logger, warning, "module " << name() << ": unexpected item in '" << attr << "': "
+             << decl.text << ", expecting key string or tuple (type, src, key)");
+    }
+  }
+
+  MsgLog(logger, debug, "module " << name() << " " << attr << ": " << decls.size() << " item(s)");
+  for (std::vector<DataDeclaration>::const_iterator it = decls.begin(); it != decls.end(); ++ it) {
+    MsgLog(logger, debug, "    " << it->text);
+  }
+}
+
+void
+PythonModule::checkDeclarations(std::vector<DataDeclaration>& decls, PSEvt::Event& evt, PyObject* pyevt,
+    const char* what)
+{
+  for (std::vector<DataDeclaration>::iterator it = decls.begin(); it != decls.end(); ++ it) {
+    if (it->warned) continue;
+
+    bool found = false;
+    if (it->type) {
+      // typed data go through converters, same as Event.get() from module
+      const int nargs = it->src ? 3 : 2;
+      pytools::pyshared_ptr args = pytools::make_pyshared(PyTuple_New(nargs));
+      Py_INCREF(it->type.get());
+      PyTuple_SET_ITEM(args.get(), 0, it->type.get());
+      if (it->src) {
+        Py_INCREF(it->src.get());
+        PyTuple_SET_ITEM(args.get(), 1, it->src.get());
+      }
+#ifdef IS_PY3K
+      PyTuple_SET_ITEM(args.get(), nargs-1, PyUnicode_FromString(it->key.c_str()));
+#else
+      PyTuple_SET_ITEM(args.get(), nargs-1, PyString_FromString(it->key.c_str()));
+#endif
+      pytools::pyshared_ptr get = pytools::make_pyshared(PyObject_GetAttrString(pyevt, "get"));
+      pytools::pyshared_ptr res = pytools::make_pyshared(get ? PyObject_Call(get.get(), args.get(), 0) : 0);
+      if (not res) PyErr_Clear();
+      found = res and res.get() != Py_None;
+    } else {
+      // any type, only compare keys
+      PSEvt::Source src;
+      if (it->src) src = psana_python::Source::cppObject(it->src.get());
+      std::list<PSEvt::EventKey> keys;
+      evt.proxyDict()->keys(keys, src);
+      for (std::list<PSEvt::EventKey>::const_iterator kit = keys.begin(); kit != keys.end() and not found; ++ kit) {
+        found = kit->key() == it->key;
+      }
+    }
+
+    if (not found) {
+      MsgLog(logger, warning, "module " << name() << ": declared " << what << " " << it->text
+             << " is not in event, further mismatches of this declaration are not reported");
+      it->warned = true;
+    }
+  }
+}
+
+void
+PythonModule::findChainPosition()
+{
+  // psana.modules may be changed for the same context, e.g. by a new
+  // DataSource, and modules may be added or destroyed
+  const std::string& modulesStr = configSvc().getStr("psana", "modules", "");
+  const std::list<std::string> modules = configSvc().getList("psana", "modules", std::list<std::string>());
+
+  boost::mutex::scoped_lock lock(::g_chainsMutex);
+  static const ::Chain noChain;
+  ::Chains::const_iterator cit = ::g_chains.find(m_context);
+  const ::Chain& chain = cit != ::g_chains.end() ? cit->second : noChain;
+  if (m_chainKnown and modulesStr == m_chainModules and chain.generation == m_chainGeneration) return;
+  m_chainKnown = true;
+  m_chainModules = modulesStr;
+  m_chainGeneration = chain.generation;
+  m_nextIsPython = false;
+  m_lastInChain = false;
+
+  if (not m_inChain) {
+    // module was not made by loader or DataSource, position is unknown and
+    // GIL is released after it
+  } else if (m_loaderName.empty()) {
+    // added through DataSource, after all configured modules
+    std::vector<const PythonModule*>::const_iterator it = std::find(chain.added.begin(), chain.added.end(), this);
+    if (it != chain.added.end()) {
+      if (++ it == chain.added.end()) {
+        m_lastInChain = true;
+      } else {
+        m_nextIsPython = true;
+      }
+    }
+  } else {
+    // loader makes modules from the entries of psana.modules and passes the
+    // same entries to moduleFactory(), so entries are compared without any
+    // interpretation; entries of other modules are C++ modules
+    std::list<std::string>::const_iterator it = std::find(modules.begin(), modules.end(), m_loaderName);
+    if (it == modules.end()) {
+      // list was changed after module was loaded, position is unknown
+    } else if (++ it != modules.end()) {
+      m_nextIsPython = chain.loaded.count(*it) > 0;
+    } else if (not chain.added.empty()) {
+      m_nextIsPython = true;
+    } else {
+      m_lastInChain = true;
+    }
+  }
+
+  MsgLog(logger, debug, "module " << name() << ": nextIsPython=" << m_nextIsPython
+         << " lastInChain=" << m_lastInChain);
 }
 
 // Load one user module. The name of the module has a format [Package.]Class[:name]
@@ -303,9 +655,19 @@ moduleFactory(const string& name)
   // make sure that Python is initialized correctly
   static bool pyInitOnce __attribute__((unused)) = ::py_init();
 
+  // modules can be loaded while GIL is released (e.g. PSAna.dataSource())
+  GILLocker gil;
+
+  // optionally import all configured modules at once
+  static bool warmImportOnce __attribute__((unused)) = ::warm_import();
+
   // try to import module
   MsgLog(logger, debug, "import module name=" << moduleName);
-  pytools::pyshared_ptr mod = pytools::make_pyshared(PyImport_ImportModule((char*)moduleName.c_str()));
+  pytools::pyshared_ptr mod;
+  {
+    StartupTrace trace("import " + moduleName);
+    mod = pytools::make_pyshared(PyImport_ImportModule((char*)moduleName.c_str()));
+  }
   if (not mod) {
     string msg = "failed to import module " + moduleName + ": " + ::pyExcStr();
     MsgLog(logger, error, msg);
@@ -341,7 +703,8 @@ moduleFactory(const string& name)
   }
 
   // this is a dirty hack to make module name available inside module constructor,
-  // this is not thread safe
+  // this is not thread safe, the class is locked until the attribute is removed
+  ObjectLock classLock(cls.get(), ObjectLock::TypeObject);
   MsgLog(logger, debug, "set special attribute for module name");
 #ifdef IS_PY3K
   pytools::pyshared_ptr modname = pytools::make_pyshared(PyUnicode_FromString(fullName.c_str()));
@@ -352,6 +715,8 @@ moduleFactory(const string& name)
     throw ExceptionGenericPyError(ERR_LOC, "PyObject_SetAttrString failed");
   }
 
+  StartupTrace instanceTrace("instantiate " + fullName);
+
   // Make empty positional args list.
   pytools::pyshared_ptr args = pytools::make_pyshared(PyTuple_New(0));
 
@@ -432,6 +797,7 @@ moduleFactory(const string& name)
     PyErr_Clear();
   }
 
+  module->addToChain(name);
   return module;
 }
 
@@ -443,10 +809,71 @@ moduleFactory(const string& name)
 namespace {
 
 
+bool parseDeclaration(PyObject* item, psana_python::PythonModule::DataDeclaration& decl)
+{
+  pytools::pyshared_ptr repr = pytools::make_pyshared(PyObject_Repr(item));
+  if (repr) {
+    decl.text = PyString_AsString_Compatible(repr.get());
+  } else {
+    PyErr_Clear();
+    decl.text = "<?>";
+  }
+
+  // plain string is a key
+  if (::isString(item)) {
+    decl.key = PyString_AsString_Compatible(item);
+    return true;
+  }
+
+  // tuple follows arguments of Event.get()
+  if (not PyTuple_Check(item)) return false;
+  const Py_ssize_t size = PyTuple_GET_SIZE(item);
+  if (size < 1 or size > 3) return false;
+
+  PyObject* type = PyTuple_GET_ITEM(item, 0);
+  if (type != Py_None) {
+    if (not PyType_Check(type)) return false;
+    decl.type = pytools::make_pyshared(type, false);
+  }
+
+  PyObject* src = size > 1 ? PyTuple_GET_ITEM(item, 1) : Py_None;
+  PyObject* key = size > 2 ? PyTuple_GET_ITEM(item, 2) : Py_None;
+  if (size == 2 and ::isString(src)) {
+    // (type, key)
+    std::swap(src, key);
+  }
+
+  if (psana_python::Source::Object_TypeCheck(src)) {
+    decl.src = pytools::make_pyshared(src, false);
+  } else if (::isString(src)) {
+    try {
+      PSEvt::Source source(PyString_AsString_Compatible(src));
+      decl.src = pytools::make_pyshared(psana_python::Source::PyObject_FromCpp(source));
+    } catch (const std::exception&) {
+      return false;
+    }
+  } else if (src != Py_None) {
+    return false;
+  }
+
+  if (::isString(key)) {
+    decl.key = PyString_AsString_Compatible(key);
+  } else if (key != Py_None) {
+    return false;
+  }
+
+  return true;
+}
+
 bool py_init()
 {
+  psana_python::StartupTrace trace("py_init");
+
   // Make sure python is initialized
-  Py_Initialize();
+  if (not Py_IsInitialized()) Py_Initialize();
+
+  // when called from Python GIL may be released by the caller
+  psana_python::GILLocker gil;
 
   // Some things (like IPython.embed) may depend on sys.argv which may not be defined
   // by default (depending on how psana is instantiated), set it here.
@@ -477,6 +904,83 @@ bool py_init()
   return true;
 }
 
+#ifdef IS_PY3K
+// Finds all modules first using several threads, this overlaps file system
+// lookups which are slow on network file systems, and then imports them.
+// Any errors are ignored, they will be reported when module is loaded.
+const char warmImportCode[] =
+  "def warm_import(names):\n"
+  "    import importlib, importlib.machinery, importlib.util, os\n"
+  "    from concurrent.futures import ThreadPoolExecutor\n"
+  "    def find(name):\n"
+  "        # find_spec() of a dotted name imports parent packages, only top-level\n"
+  "        # package is looked up here, module itself is found in file system\n"
+  "        package, _, module = name.rpartition('.')\n"
+  "        if not package or '.' in package:\n"
+  "            return False\n"
+  "        try:\n"
+  "            spec = importlib.util.find_spec(package)\n"
+  "        except Exception:\n"
+  "            return False\n"
+  "        if spec is None or not spec.submodule_search_locations:\n"
+  "            return False\n"
+  "        for path in spec.submodule_search_locations:\n"
+  "            base = os.path.join(path, module)\n"
+  "            if os.path.isfile(os.path.join(base, '__init__.py')):\n"
+  "                return True\n"
+  "            if any(os.path.isfile(base + sfx) for sfx in importlib.machinery.all_suffixes()):\n"
+  "                return True\n"
+  "        return False\n"
+  "    with ThreadPoolExecutor(max_workers=max(1, min(16, len(names)))) as pool:\n"
+  "        found = [name for name, ok in zip(names, pool.map(find, names)) if ok]\n"
+  "    for name in found:\n"
+  "        try:\n"
+  "            importlib.import_module(name)\n"
+  "        except Exception:\n"
+  "            pass\n"
+  "    return found\n";
+#endif
+
+bool warm_import()
+{
+  ConfigSvc::ConfigSvc cfg(psana::Context::get());
+  if (not cfg.get("psana", "warm_import", false)) return false;
+
+#ifdef IS_PY3K
+  psana_python::StartupTrace trace("warm_import");
+
+  // Python module names for all modules, C++ modules will not be found
+  std::list<std::string> modules = cfg.getList("psana", "modules", std::list<std::string>());
+  pytools::pyshared_ptr names = pytools::make_pyshared(PyList_New(0));
+  std::set<std::string> seen;
+  for (std::list<std::string>::const_iterator it = modules.begin(); it != modules.end(); ++ it) {
+    std::string name = it->substr(0, it->find(':'));
+    if (name.find('.') == std::string::npos) name = "psana." + name;
+    if (not seen.insert(name).second) continue;
+    pytools::pyshared_ptr pyname = pytools::make_pyshared(PyUnicode_FromString(name.c_str()));
+    PyList_Append(names.get(), pyname.get());
+  }
+
+  pytools::pyshared_ptr globals = pytools::make_pyshared(PyDict_New());
+  PyDict_SetItemString(globals.get(), "__builtins__", PyEval_GetBuiltins());
+  pytools::pyshared_ptr res = pytools::make_pyshared(PyRun_String(::warmImportCode, Py_file_input, globals.get(), globals.get()));
+  PyObject* func = PyDict_GetItemString(globals.get(), "warm_import");
+  if (res and func) {
+    res = pytools::make_pyshared(PyObject_CallFunctionObjArgs(func, names.get(), NULL));
+  }
+  if (not res or not func) {
+    MsgLog(logger, warning, "warm import failed: " << ::pyExcStr());
+    return false;
+  }
+  MsgLog(logger, debug, "warm import: " << PyList_GET_SIZE(res.get()) << " of "
+         << PyList_GET_SIZE(names.get()) << " modules imported");
+#else
+  MsgLog(logger, debug, "psana.warm_import is only supported with Python 3");
+#endif
+
+  return true;
+}
+
 psana_python::PythonModule*
 cpp_module(PyObject* self)
 {
@@ -533,6 +1037,136 @@ cpp_module(PyObject* self)
   }
 }
 
+PyObject*
+configValue(const std::string& str)
+{
+  std::vector<std::string> words;
+  std::istringstream stream(str);
+  for (std::string word; stream >> word; ) words.push_back(word);
+
+  // parse words as integer or floating point numbers, stop at first non-number;
+  // integers take base prefixes (0x, 0) like ConfigSvc does, numbers which do
+  // not fit C++ types are not converted so that value stays a string
+  std::vector<long> ivals;
+  std::vector<double> fvals;
+  for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++ it) {
+    char* end = 0;
+    errno = 0;
+    long ival = std::strtol(it->c_str(), &end, 0);
+    if (*end == '\0') {
+      if (errno == ERANGE) break;
+      ivals.push_back(ival);
+      fvals.push_back(double(ival));
+      continue;
+    }
+    if (not ::isPlainFloat(*it)) break;
+    errno = 0;
+    double fval = std::strtod(it->c_str(), &end);
+    if (*end != '\0') break;
+    if (errno == ERANGE and (fval == HUGE_VAL or fval == -HUGE_VAL)) break;
+    fvals.push_back(fval);
+  }
+
+  if (words.size() == 1) {
+    if (ivals.size() == 1) {
+#ifdef IS_PY3K
+      return PyLong_FromLong(ivals[0]);
+#else
+      return PyInt_FromLong(ivals[0]);
+#endif
+    }
+    if (fvals.size() == 1) return PyFloat_FromDouble(fvals[0]);
+    std::string lower = words[0];
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "true" or lower == "yes" or lower == "on") Py_RETURN_TRUE;
+    if (lower == "false" or lower == "no" or lower == "off") Py_RETURN_FALSE;
+  } else if (words.size() > 1 and fvals.size() == words.size()) {
+    // list of numbers becomes read-only 1-dim array
+    npy_intp size = words.size();
+    const bool isInt = ivals.size() == words.size();
+    PyObject* array = PyArray_SimpleNew(1, &size, isInt ? NPY_LONG : NPY_DOUBLE);
+    if (not array) return 0;
+    if (isInt) {
+      std::copy(ivals.begin(), ivals.end(), (long*)PyArray_DATA(array));
+    } else {
+      std::copy(fvals.begin(), fvals.end(), (double*)PyArray_DATA(array));
+    }
+    PyArray_CLEARFLAGS((PyArrayObject*)array, NPY_ARRAY_WRITEABLE);
+    return array;
+  }
+
+  // anything else is a string
+#ifdef IS_PY3K
+  return PyUnicode_FromString(str.c_str());
+#else
+  return PyString_FromString(str.c_str());
+#endif
+}
+
+bool
+isPlainFloat(const std::string& word)
+{
+  std::string::const_iterator it = word.begin();
+  if (it != word.end() and (*it == '+' or *it == '-')) ++ it;
+
+  unsigned digits = 0;
+  bool fraction = false;
+  for (; it != word.end() and std::isdigit(*it); ++ it) ++ digits;
+  if (it != word.end() and *it == '.') {
+    fraction = true;
+    for (++ it; it != word.end() and std::isdigit(*it); ++ it) ++ digits;
+  }
+  if (digits == 0) return false;
+
+  bool exponent = false;
+  if (it != word.end() and (*it == 'e' or *it == 'E')) {
+    ++ it;
+    if (it != word.end() and (*it == '+' or *it == '-')) ++ it;
+    if (it == word.end() or not std::isdigit(*it)) return false;
+    while (it != word.end() and std::isdigit(*it)) ++ it;
+    exponent = true;
+  }
+
+  // words without fraction or exponent are integers, strtol() has already
+  // rejected them (e.g. "08" is not a valid octal number)
+  return it == word.end() and (fraction or exponent);
+}
+
+PyObject*
+configCached(PyObject* self, const char* method, PyObject* args, PyCFunction func)
+{
+  psana_python::PythonModule* module = cpp_module(self);
+  if (not module) return 0;
+
+  if (module->inEvent() and module->warnConfigInEvent()) {
+    pytools::pyshared_ptr argstr = pytools::make_pyshared(PyObject_Repr(args));
+    MsgLog(logger, warning, "module " << module->name() << " calls " << method
+        << (argstr ? PyString_AsString_Compatible(argstr.get()) : std::string("(...)"))
+        << " from event() method, consider using self.config or reading parameters in constructor"
+        " (further calls will not be reported)");
+    PyErr_Clear();
+  }
+
+  pytools::pyshared_ptr key = pytools::make_pyshared(Py_BuildValue("(sO)", method, args));
+  if (not key) return 0;
+
+  // Borrowed reference, if key is not hashable (e.g. list given as default
+  // value) then lookup fails and result is just not cached
+  PyObject* res = PyDict_GetItem(module->configCache(), key.get());
+  pytools::pyshared_ptr val;
+  if (not res) {
+    val = pytools::make_pyshared(func(self, args));
+    if (not val) return 0;
+    if (PyDict_SetItem(module->configCache(), key.get(), val.get()) < 0) PyErr_Clear();
+    res = val.get();
+  }
+
+  // return copies of lists so that cached lists cannot be modified by caller
+  if (PyList_Check(res)) return PyList_GetSlice(res, 0, PyList_GET_SIZE(res));
+  Py_INCREF(res);
+  return res;
+}
+
 PyObject*
 extra_name(PyObject* self, PyObject* args)
 {
@@ -0,0 +1,89 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StartupTrace...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/StartupTrace.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <time.h>
+#include <boost/thread/mutex.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "MsgLogger/MsgLogger.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+  const char logger[] = "psana_python.StartupTrace";
+
+  double now()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+  // only first phases are kept, modules can be made repeatedly in long jobs
+  const size_t MaxEntries = 1000;
+
+  // modules can be loaded from several threads
+  boost::mutex g_mutex;
+  std::vector<psana_python::StartupTrace::Entry> g_entries;
+  const double g_origin = now();
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+StartupTrace::StartupTrace(const std::string& phase)
+  : m_phase(phase)
+  , m_start(::now())
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+StartupTrace::~StartupTrace()
+{
+  Entry entry;
+  entry.phase = m_phase;
+  entry.start = m_start - ::g_origin;
+  entry.duration = ::now() - m_start;
+
+  MsgLog(logger, debug, "startup phase " << entry.phase << ": " << entry.duration * 1e3 << " ms");
+
+  boost::mutex::scoped_lock lock(::g_mutex);
+  if (::g_entries.size() < MaxEntries) ::g_entries.push_back(entry);
+}
+
+std::vector<StartupTrace::Entry>
+StartupTrace::entries()
+{
+  boost::mutex::scoped_lock lock(::g_mutex);
+  return ::g_entries;
+}
+
+} // namespace psana_python
@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StlConvertTest...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/StlConvertTest.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <deque>
+#include <list>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include <boost/python.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "psana_python/GILReleaser.h"
+#include "PSEvt/Event.h"
+#include "pytools/make_pyshared.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+// This declares this class as psana module
+using namespace psana_python;
+PSANA_MODULE_FACTORY(StlConvertTest)
+
+namespace {
+
+  // convert container with BOOST converter and store result as Python object
+  template <typename Container>
+  void putConverted(PSEvt::Event& evt, const Container& cont, const std::string& key)
+  {
+    boost::python::object obj(cont);
+    evt.put(pytools::make_pyshared(obj.ptr(), false), key);
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+StlConvertTest::StlConvertTest (const std::string& name)
+  : psana::Module(name)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+StlConvertTest::~StlConvertTest ()
+{
+}
+
+/// Method which is called with event data
+void
+StlConvertTest::event(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  // converters need GIL, module may run in a thread without it
+  GILLocker gil;
+
+  std::vector<double> vec;
+  vec.push_back(1.5);
+  vec.push_back(2.5);
+  ::putConverted(evt, vec, "stl_vector");
+
+  std::deque<int32_t> deq;
+  deq.push_back(1);
+  deq.push_back(2);
+  deq.push_back(3);
+  ::putConverted(evt, deq, "stl_deque");
+
+  std::list<uint16_t> lst;
+  lst.push_back(7);
+  lst.push_back(8);
+  ::putConverted(evt, lst, "stl_list");
+
+  std::vector<std::pair<float, float> > pairs;
+  pairs.push_back(std::make_pair(1.f, 2.f));
+  pairs.push_back(std::make_pair(3.f, 4.f));
+  ::putConverted(evt, pairs, "stl_pairs");
+
+  std::vector<std::string> strings;
+  strings.push_back("a");
+  strings.push_back("bc");
+  strings.push_back("");
+  ::putConverted(evt, strings, "stl_strings");
+
+  ::putConverted(evt, std::vector<int64_t>(), "stl_empty");
+}
+
+} // namespace psana_python
@@ -0,0 +1,406 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Registration of C++ structs as numpy structured dtypes.
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/StructDtype.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "MsgLogger/MsgLogger.h"
+#include "psana_python/ConverterStats.h"
+#include "psana_python/ObjectLock.h"
+#include "psddl_python/psddl_python_numpy.h"
+#include "psana_python/NdarrayWrapper.h"
+#include "psddl_python/Converter.h"
+#include "psddl_python/ConverterMap.h"
+#include "PSEvt/EventKey.h"
+#include "pytools/make_pyshared.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+using psddl_python::ConverterMap;
+using psana_python::ConverterStats;
+using psana_python::StructRankOps;
+using psana_python::StructField;
+using psana_python::StructMaxRank;
+
+namespace {
+
+  const char logger[] = "psana_python.StructDtype";
+
+  // One registered struct type, never deleted
+  struct Entry {
+    const std::type_info* type;
+    std::string name;
+    PyObject* dtype;
+    StructRankOps ops[StructMaxRank];
+    PyObject* pytypes[StructMaxRank];
+  };
+
+  // registered structs, protected by converter map lock
+  std::vector<Entry*> g_entries;
+
+  // Converter from ndarray<Struct,Rank> in event to numpy array
+  class StructToNumpyCvt : public psddl_python::Converter {
+  public:
+    StructToNumpyCvt(const Entry* entry, unsigned rank) : m_entry(entry), m_rank(rank) {}
+
+    virtual std::vector<const std::type_info*> from_cpp_types() const {
+      std::vector<const std::type_info*> types;
+      types.push_back(m_entry->ops[m_rank-1].type);
+      types.push_back(m_entry->ops[m_rank-1].constType);
+      return types;
+    }
+
+    virtual std::vector<PyTypeObject*> from_py_types() const {
+      return std::vector<PyTypeObject*>();
+    }
+
+    virtual std::vector<PyTypeObject*> to_py_types() const {
+      return std::vector<PyTypeObject*>(1, (PyTypeObject*)m_entry->pytypes[m_rank-1]);
+    }
+
+    virtual PyObject* convert(PSEvt::ProxyDictI& proxyDict, const PSEvt::Source& source, const std::string& key) const {
+      // same rules as for ndarrays of numbers, objects of both const and
+      // non-const types with the same source and key are an error
+      const StructRankOps& ops = m_entry->ops[m_rank-1];
+      bool isConst = false;
+      Pds::Src foundSrc;
+      boost::shared_ptr<void> vdata = proxyDict.get(ops.type, source, key, &foundSrc);
+      if (vdata) {
+        if (proxyDict.exists(PSEvt::EventKey(ops.constType, foundSrc, key))) {
+          std::ostringstream msg;
+          msg << "Both const and non-const element type found for ndarray<" << m_entry->name
+              << "," << m_rank << "> for event key with source=" << source << " and key=" << key
+              << " convert is ambiguous. Use key string to distingish.";
+          throw std::runtime_error(msg.str());
+        }
+      } else {
+        isConst = true;
+        vdata = proxyDict.get(ops.constType, source, key, 0);
+        if (not vdata) return 0;
+      }
+      return ops.toNumpy(vdata, isConst, m_entry->dtype);
+    }
+
+  private:
+    const Entry* m_entry;
+    unsigned m_rank;
+  };
+
+  // Converter from numpy array with registered dtype to ndarray<Struct,Rank>
+  class StructFromNumpyCvt : public psddl_python::Converter {
+  public:
+    explicit StructFromNumpyCvt(const Entry* entry) : m_entry(entry) {}
+
+    virtual std::vector<const std::type_info*> from_cpp_types() const {
+      return std::vector<const std::type_info*>();
+    }
+
+    virtual std::vector<PyTypeObject*> from_py_types() const {
+      return std::vector<PyTypeObject*>(1, &PyArray_Type);
+    }
+
+    virtual std::vector<PyTypeObject*> to_py_types() const {
+      return std::vector<PyTypeObject*>();
+    }
+
+    virtual PyObject* convert(PSEvt::ProxyDictI&, const PSEvt::Source&, const std::string&) const {
+      return 0;
+    }
+
+    virtual bool convert(PyObject* obj, PSEvt::ProxyDictI& proxyDict, const Pds::Src& source, const std::string& key) const {
+      if (not PyArray_Check(obj) or PyArray_TYPE(obj) != NPY_VOID) return false;
+      if (not PyArray_EquivTypes((PyArray_Descr*)m_entry->dtype, PyArray_DESCR(obj))) return false;
+
+      const int rank = PyArray_NDIM(obj);
+      if (rank < 1 or rank > StructMaxRank) {
+        ConverterStats::reject(ConverterStats::WrongRank);
+        return false;
+      }
+      // C++ code can only use aligned structs
+      if (not PyArray_ISALIGNED(obj)) {
+        ConverterStats::reject(ConverterStats::WrongObject);
+        return false;
+      }
+
+      const npy_intp itemsize = PyArray_ITEMSIZE(obj);
+      unsigned shape[rank];
+      int strides[rank];
+      for (int i = 0; i != rank; ++ i) {
+        if (PyArray_STRIDE(obj, i) % itemsize) {
+          ConverterStats::reject(ConverterStats::WrongObject);
+          return false;
+        }
+        shape[i] = PyArray_DIM(obj, i);
+        strides[i] = PyArray_STRIDE(obj, i) / itemsize;
+      }
+
+      pytools::pyshared_ptr owner = pytools::make_pyshared(obj, false);
+      m_entry->ops[rank-1].save(owner, PyArray_DATA(obj), shape, strides, proxyDict, source, key,
+                                PyArray_ISWRITEABLE(obj));
+
+      ConverterStats::count(ConverterStats::FromNumpy, NPY_VOID, "struct", rank, PyArray_NBYTES(obj));
+      return true;
+    }
+
+  private:
+    const Entry* m_entry;
+  };
+
+  // Capsule destructor for base of numpy arrays, capsule holds shared pointer
+  void deleteOwner(PyObject* capsule)
+  {
+    delete static_cast<boost::shared_ptr<void>*>(PyCapsule_GetPointer(capsule, "psana.StructArray"));
+  }
+
+  // Layout check, fields must have matching sizes, be aligned, not overlap
+  // and fit in the struct. Returns numpy dtype or zero.
+  PyObject* makeDtype(const std::string& name, size_t size, const StructField fields[], size_t nfields)
+  {
+    if (nfields == 0) {
+      MsgLog(logger, error, "struct " << name << ": no fields defined");
+      return 0;
+    }
+
+    std::vector<std::pair<size_t, size_t> > extents;
+    PyObject* names = PyList_New(nfields);
+    PyObject* formats = PyList_New(nfields);
+    PyObject* offsets = PyList_New(nfields);
+    bool ok = true;
+    for (size_t i = 0; i != nfields and ok; ++ i) {
+      const StructField& field = fields[i];
+
+      PyArray_Descr* fdescr = 0;
+      PyObject* format = Py_BuildValue("s", field.format);
+      ok = format and PyArray_DescrConverter(format, &fdescr);
+      Py_XDECREF(format);
+      if (not ok) {
+        PyErr_Clear();
+        MsgLog(logger, error, "struct " << name << ": invalid format '" << field.format << "' for field " << field.name);
+        break;
+      }
+
+      if (PyDataType_REFCHK(fdescr)) {
+        MsgLog(logger, error, "struct " << name << ": field " << field.name << " cannot be Python object");
+        ok = false;
+      } else if (size_t(fdescr->elsize) != field.size) {
+        MsgLog(logger, error, "struct " << name << ": field " << field.name << " has size " << field.size
+               << " but format '" << field.format << "' has size " << fdescr->elsize);
+        ok = false;
+      } else if (field.offset % fdescr->alignment) {
+        MsgLog(logger, error, "struct " << name << ": field " << field.name << " is not aligned");
+        ok = false;
+      } else if (field.offset + field.size > size) {
+        MsgLog(logger, error, "struct " << name << ": field " << field.name << " is outside of struct");
+        ok = false;
+      }
+
+      PyList_SET_ITEM(names, i, Py_BuildValue("s", field.name));
+      PyList_SET_ITEM(formats, i, (PyObject*)fdescr);
+      PyList_SET_ITEM(offsets, i, PyLong_FromSize_t(field.offset));
+      extents.push_back(std::make_pair(field.offset, field.size));
+    }
+
+    std::sort(extents.begin(), extents.end());
+    for (size_t i = 1; ok and i < extents.size(); ++ i) {
+      if (extents[i-1].first + extents[i-1].second > extents[i].first) {
+        MsgLog(logger, error, "struct " << name << ": fields overlap at offset " << extents[i].first);
+        ok = false;
+      }
+    }
+
+    if (not ok) {
+      Py_DECREF(names);
+      Py_DECREF(formats);
+      Py_DECREF(offsets);
+      return 0;
+    }
+
+    PyObject* spec = Py_BuildValue("{s:N,s:N,s:N,s:n}", "names", names, "formats", formats,
+                                   "offsets", offsets, "itemsize", Py_ssize_t(size));
+    PyArray_Descr* descr = 0;
+    if (not spec or not PyArray_DescrConverter(spec, &descr)) {
+      PyErr_Clear();
+      MsgLog(logger, error, "struct " << name << ": numpy failed to make dtype");
+      descr = 0;
+    } else if (size_t(descr->elsize) != size) {
+      MsgLog(logger, error, "struct " << name << ": dtype size " << descr->elsize << " differs from struct size " << size);
+      Py_CLEAR(descr);
+    }
+    Py_XDECREF(spec);
+    return (PyObject*)descr;
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+bool
+registerStructDtype(const std::type_info& type, const std::string& name, size_t size,
+    const StructField fields[], size_t nfields, const StructRankOps ops[StructMaxRank])
+{
+  PyObject* module = ndarrayWrapperModule();
+  if (not module) {
+    MsgLog(logger, error, "struct " << name << ": _psana module is not initialized");
+    return false;
+  }
+
+  ConverterMap& cmap = ConverterMap::instance();
+  ObjectLock lock(&cmap, ObjectLock::Converters);
+
+  for (std::vector<Entry*>::const_iterator it = g_entries.begin(); it != g_entries.end(); ++ it) {
+    if (*(*it)->type == type or (*it)->name == name) {
+      MsgLog(logger, error, "struct " << name << ": type or name is registered already");
+      return false;
+    }
+  }
+
+  std::string typeNames[StructMaxRank];
+  for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+    typeNames[rank-1] = "ndarray_" + name + "_" + boost::lexical_cast<std::string>(rank);
+    if (PyObject_HasAttrString(module, typeNames[rank-1].c_str())) {
+      MsgLog(logger, error, "struct " << name << ": module already has attribute " << typeNames[rank-1]);
+      return false;
+    }
+  }
+
+  // Everything is made first and only published when nothing can fail,
+  // so failed registration leaves no traces and can be retried
+  pytools::pyshared_ptr dtype = pytools::make_pyshared(::makeDtype(name, size, fields, nfields));
+  if (not dtype) return false;
+
+  // Python types only serve as keys for Event.get()
+  pytools::pyshared_ptr pytypes[StructMaxRank];
+  for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+    const std::string doc = "Type used as an argument for Event.get() to get ndarray of struct " + name +
+        " and rank " + boost::lexical_cast<std::string>(rank) + " as numpy array with structured dtype.";
+    pytypes[rank-1] = pytools::make_pyshared(PyObject_CallFunction((PyObject*)&PyType_Type,
+        const_cast<char*>("s(O){s:s,s:s}"), typeNames[rank-1].c_str(), &PyBaseObject_Type,
+        "__module__", "psana", "__doc__", doc.c_str()));
+    if (not pytypes[rank-1]) {
+      PyErr_Clear();
+      MsgLog(logger, error, "struct " << name << ": failed to make type " << typeNames[rank-1]);
+      return false;
+    }
+  }
+
+  // entry is owned here until it is published in g_entries
+  Entry* entry = new Entry;
+  entry->type = &type;
+  entry->name = name;
+  entry->dtype = dtype.get();
+  std::copy(ops, ops+StructMaxRank, entry->ops);
+  for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+    entry->pytypes[rank-1] = pytypes[rank-1].get();
+  }
+
+  std::vector<boost::shared_ptr<psddl_python::Converter> > converters;
+  try {
+    for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+      converters.push_back(boost::make_shared< ::StructToNumpyCvt>(entry, rank));
+    }
+    converters.push_back(boost::make_shared< ::StructFromNumpyCvt>(entry));
+    g_entries.reserve(g_entries.size() + 1);
+  } catch (...) {
+    delete entry;
+    throw;
+  }
+
+  // adding to module is the only step which can fail, undo it on failure
+  for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+    if (PyObject_SetAttrString(module, typeNames[rank-1].c_str(), pytypes[rank-1].get()) < 0) {
+      PyErr_Clear();
+      MsgLog(logger, error, "struct " << name << ": failed to add type " << typeNames[rank-1] << " to module");
+      for (unsigned i = 1; i < rank; ++ i) {
+        if (PyObject_DelAttrString(module, typeNames[i-1].c_str()) < 0) PyErr_Clear();
+      }
+      converters.clear();
+      delete entry;
+      return false;
+    }
+  }
+
+  // entry owns one reference to dtype and types, it is never deleted
+  Py_INCREF(entry->dtype);
+  for (unsigned rank = 1; rank <= StructMaxRank; ++ rank) {
+    Py_INCREF(entry->pytypes[rank-1]);
+  }
+  g_entries.push_back(entry);
+  for (std::vector<boost::shared_ptr<psddl_python::Converter> >::const_iterator it = converters.begin();
+       it != converters.end(); ++ it) {
+    cmap.addConverter(*it);
+  }
+
+  MsgLog(logger, debug, "registered struct " << name << " with dtype size " << size);
+  return true;
+}
+
+PyObject*
+structDtype(const std::type_info& type)
+{
+  ConverterMap& cmap = ConverterMap::instance();
+  ObjectLock lock(&cmap, ObjectLock::Converters);
+
+  for (std::vector<Entry*>::const_iterator it = g_entries.begin(); it != g_entries.end(); ++ it) {
+    if (*(*it)->type == type) return (*it)->dtype;
+  }
+  return 0;
+}
+
+PyObject*
+structArrayToNumpy(PyObject* dtype, unsigned rank, const unsigned shape[], const int strides[],
+    size_t itemsize, const void* data, const boost::shared_ptr<void>& owner, bool writeable)
+{
+  npy_intp dims[rank];
+  npy_intp bstrides[rank];
+  for (unsigned i = 0; i != rank; ++ i) {
+    dims[i] = shape[i];
+    bstrides[i] = npy_intp(strides[i]) * itemsize;
+  }
+
+  // numpy updates contiguity and alignment flags itself, steals dtype
+  Py_INCREF(dtype);
+  PyObject* array = PyArray_NewFromDescr(&PyArray_Type, (PyArray_Descr*)dtype, rank, dims, bstrides,
+                                         const_cast<void*>(data), writeable ? NPY_WRITEABLE : 0, 0);
+  if (not array) return 0;
+
+  // base object keeps C++ data alive
+  boost::shared_ptr<void>* powner = new boost::shared_ptr<void>(owner);
+  PyObject* base = PyCapsule_New(powner, "psana.StructArray", ::deleteOwner);
+  if (not base) {
+    delete powner;
+    Py_DECREF(array);
+    return 0;
+  }
+  ((PyArrayObject*)array)->base = base;
+
+  ConverterStats::count(ConverterStats::ToNumpy, NPY_VOID, "struct", rank, PyArray_NBYTES(array));
+  return array;
+}
+
+} // namespace psana_python
@@ -0,0 +1,169 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class StructDtypeTest...
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "psana_python/StructDtypeTest.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <sstream>
+#include <stdint.h>
+#include <boost/make_shared.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "ndarray/ndarray.h"
+#include "psana_python/GILReleaser.h"
+#include "psana_python/StructDtype.h"
+#include "PSEvt/Event.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+// This declares this class as psana module
+using namespace psana_python;
+PSANA_MODULE_FACTORY(StructDtypeTest)
+
+namespace {
+
+  struct TestPeak {
+    float x;
+    float y;
+    uint32_t npix;
+    uint16_t flags;
+    int16_t charge;
+    double sum;
+  };
+
+  const StructField goodFields[] = {
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, x, "f4"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, y, "f4"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, npix, "u4"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, flags, "u2"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, charge, "i2"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, sum, "f8"),
+  };
+
+  // format size does not match member size
+  const StructField badSizeFields[] = {
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, x, "f8"),
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, y, "f4"),
+  };
+
+  // double at offset 4
+  const StructField misalignedFields[] = {
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, x, "f4"),
+    { "xy", "f8", 4, 8 },
+  };
+
+  // second field overlaps first one
+  const StructField overlapFields[] = {
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, npix, "u4"),
+    { "npix_hi", "u2", 10, 2 },
+  };
+
+  // field goes past the end of struct
+  const StructField outsideFields[] = {
+    PSANA_PYTHON_STRUCT_FIELD(TestPeak, x, "f4"),
+    { "extra", "f8", sizeof(TestPeak), 8 },
+  };
+
+  template <unsigned N>
+  bool tryRegister(const StructField (&fields)[N])
+  {
+    return registerStructDtype<TestPeak>("testpeak", fields, N);
+  }
+
+  // Try all field tables, all wrong layouts are rejected first, failed
+  // registration must not prevent later registration of the same type and
+  // name. Must be called with GIL held.
+  std::string registerAll()
+  {
+    std::ostringstream str;
+    str << "bad_size=" << tryRegister(badSizeFields);
+    str << " misaligned=" << tryRegister(misalignedFields);
+    str << " overlap=" << tryRegister(overlapFields);
+    str << " outside=" << tryRegister(outsideFields);
+    str << " good=" << tryRegister(goodFields);
+    str << " duplicate=" << tryRegister(goodFields);
+    return str.str();
+  }
+
+  void fill(TestPeak* peaks, unsigned n)
+  {
+    for (unsigned i = 0; i != n; ++ i) {
+      peaks[i].x = i;
+      peaks[i].y = 2*i;
+      peaks[i].npix = 10 + i;
+      peaks[i].flags = i;
+      peaks[i].charge = -int(i);
+      peaks[i].sum = 0.5*i;
+    }
+  }
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace psana_python {
+
+//----------------
+// Constructors --
+//----------------
+StructDtypeTest::StructDtypeTest (const std::string& name)
+  : psana::Module(name)
+  , m_results()
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+StructDtypeTest::~StructDtypeTest ()
+{
+}
+
+/// Method which is called once at the beginning of the job
+void
+StructDtypeTest::beginJob(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  // registration needs GIL, module may run in a thread without it,
+  // registration is only done once per process by the first instance
+  GILLocker gil;
+  static const std::string results = ::registerAll();
+  m_results = results;
+}
+
+/// Method which is called with event data
+void
+StructDtypeTest::event(PSEvt::Event& evt, PSEnv::Env& env)
+{
+  evt.put(boost::make_shared<std::string>(m_results), "struct_dtype_test");
+
+  ndarray<TestPeak, 1> peaks1 = make_ndarray<TestPeak>(3);
+  ::fill(peaks1.data(), peaks1.size());
+  evt.put(boost::make_shared<ndarray<TestPeak, 1> >(peaks1), "peaks1");
+
+  ndarray<TestPeak, 2> peaks2 = make_ndarray<TestPeak>(2, 3);
+  ::fill(peaks2.data(), peaks2.size());
+  evt.put(boost::make_shared<ndarray<const TestPeak, 2> >(peaks2), "peaks2");
+
+  // const and non-const arrays with the same key cannot be converted
+  evt.put(boost::make_shared<ndarray<TestPeak, 1> >(peaks1), "peaks_both");
+  evt.put(boost::make_shared<ndarray<const TestPeak, 1> >(peaks1), "peaks_both");
+}
+
+} // namespace psana_python
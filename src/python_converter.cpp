@@ -8,8 +8,10 @@
 #include <boost/preprocessor/seq/for_each_product.hpp>
 #include <boost/preprocessor/seq/elem.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/type_traits/remove_const.hpp>
 
 #include <pytools/PyDataType.h>
+#include <pytools/PyUtil.h>
 
 #include <PSEvt/Event.h>
 #include <psana_python/Event.h>
@@ -20,70 +22,92 @@
 #include <PSEvt/Source.h>
 #include <psana_python/Source.h>
 
+#include <psana_python/ConverterStats.h>
+#include <psana_python/GILReleaser.h>
+#include <psana_python/NdarrayWrapper.h>
 
+
+#include <algorithm>
+#include <deque>
 #include <string>
 #include <iostream>
 #include "MsgLogger/MsgLogger.h"
 
 
-// set of ranks and types for which we instantiate converters
-#define ND_RANKS (1)(2)(3)(4)(5)(6)
-#define ND_TYPES (int8_t)(uint8_t)(int16_t)(uint16_t)(int32_t)(uint32_t)(int64_t)(uint64_t)(float)(double)
-#define CONST_ND_TYPES (const int8_t)(const uint8_t)(const int16_t)(const uint16_t)(const int32_t)(const uint32_t)(const int64_t)(const uint64_t)(const float)(const double)
- 
-
 namespace psana_python {
 
   // String to identify debug statements produced by this code
   const char *pyConverterlogger = "Python_Converter";
-  
-  void createConverters() {
-    
-    // Initialise NUMPY 
-    _import_array();
 
-    // These templates and BOOST preprocessor macros can be hard to understand what's
-    // going on.  Here's a couple of examples of what they trying to do....
-    //
-    // Let's say we want converters for doubles NDarrays for 1-3 dimensions   
-    // Without the BOOST macros above we would have to do this:
-    // 
-    // boost::python::to_python_converter<ndarray<double,1>,NDArrayToNumpy<double,1> >();
-    // boost::python::to_python_converter<ndarray<double,2>,NDArrayToNumpy<double,2> >();
-    // boost::python::to_python_converter<ndarray<double,3>,NDArrayToNumpy<double,3> >();
-    //  
-    // NumpyToNDArray<float,1>().from_python();
-    // NumpyToNDArray<float,2>().from_python();
-    // NumpyToNDArray<float,3>().from_python();
-    // 
-    // Rather than typing each out each coverter, we used the BOOST
-    // preprosser macros to generate the code for us.
-    
-    
-    // Preprocessor macro to define the call to create a NDArray to NUMPY converter. 
-    #define REGISTER_NDARRAY_TO_NUMPY_CONVERTER(r,PRODUCT)			\
-      psana_python::NDArrayToNumpy<BOOST_PP_SEQ_ELEM(0,PRODUCT),BOOST_PP_SEQ_ELEM(1,PRODUCT)>().register_ndarray_to_numpy_cvt();
+  namespace {
 
+    // Deleter for shared pointers owning a reference to Python object,
+    // may be called from C++ threads which do not hold GIL
+    struct PyObjectReleaser {
+      void operator()(PyObject* obj) const {
+        // nothing to release if interpreter is already gone
+        if (not Py_IsInitialized()) return;
+        psana_python::GILLocker gil;
+        Py_DECREF(obj);
+      }
+    };
 
-    // Preprocessor macro to define the call to create a NUMPY to NDArray converter 
-    #define REGISTER_NUMPY_TO_NDARRAY_CONVERTER(r,PRODUCT)			\
-      psana_python::NumpyToNDArray<BOOST_PP_SEQ_ELEM(0,PRODUCT),BOOST_PP_SEQ_ELEM(1,PRODUCT)>().from_python();
-  
+    // Registers all BOOST converters for one element type and rank, both
+    // const and non-const element types and both directions
+    template <typename T, unsigned Rank>
+    void registerNdarrayConverters()
+    {
+      psana_python::NDArrayToNumpy<T,Rank>::register_ndarray_to_numpy_cvt();
+      psana_python::NDArrayToNumpy<const T,Rank>::register_ndarray_to_numpy_cvt();
+      psana_python::NumpyToNDArray<T,Rank>().from_python();
+      psana_python::NumpyToNDArray<const T,Rank>().from_python();
+    }
 
-    // BOOST preprocessor macro to create converters 1-6 dimensional NDArray, with
-    // data type from int to double, both const and non const  
-    BOOST_PP_SEQ_FOR_EACH_PRODUCT(REGISTER_NDARRAY_TO_NUMPY_CONVERTER,(ND_TYPES)(ND_RANKS))
-    BOOST_PP_SEQ_FOR_EACH_PRODUCT(REGISTER_NDARRAY_TO_NUMPY_CONVERTER,(CONST_ND_TYPES)(ND_RANKS))
-      
-    BOOST_PP_SEQ_FOR_EACH_PRODUCT(REGISTER_NUMPY_TO_NDARRAY_CONVERTER,(ND_TYPES)(ND_RANKS))
-    BOOST_PP_SEQ_FOR_EACH_PRODUCT(REGISTER_NUMPY_TO_NDARRAY_CONVERTER,(CONST_ND_TYPES)(ND_RANKS))
+    // Table of registration functions for all element types and ranks. Lookup
+    // of BOOST converters is done by C++ type at the time of the call so
+    // they cannot be registered on demand, all of them are registered when
+    // module is imported. Wrapper Python types are made by initNdarrayCvt().
+    typedef void (*RegisterFun)();
+
+#define ND_REGISTRATION(r, PRODUCT) \
+    &registerNdarrayConverters<BOOST_PP_SEQ_ELEM(0, PRODUCT), BOOST_PP_SEQ_ELEM(1, PRODUCT)>,
+
+    const RegisterFun ndarrayRegistrations[] = {
+      BOOST_PP_SEQ_FOR_EACH_PRODUCT(ND_REGISTRATION, (PSANA_PYTHON_ND_TYPES)(PSANA_PYTHON_ND_RANKS))
+    };
+
+#undef ND_REGISTRATION
 
+#define STLSEQ_REGISTRATION(r, data, ELEMENT) \
+    &psana_python::StlSeqToNumpy<std::vector<ELEMENT> >::register_stlseq_to_numpy_cvt, \
+    &psana_python::StlSeqToNumpy<std::deque<ELEMENT> >::register_stlseq_to_numpy_cvt, \
+    &psana_python::StlSeqToNumpy<std::list<ELEMENT> >::register_stlseq_to_numpy_cvt, \
+    &psana_python::StlSeqToNumpy<std::vector<std::pair<ELEMENT, ELEMENT> > >::register_stlseq_to_numpy_cvt,
 
-    // Register the STL list<ndtypes> to Numpy converters with BOOST
-    #define REGISTER_STLLIST_TO_NUMPY_CONVERTER(r,data, ELEMENT)		\
-      psana_python::StlListToNumpy< ELEMENT >().register_stllist_to_numpy_cvt();
+    const RegisterFun stlseqRegistrations[] = {
+      BOOST_PP_SEQ_FOR_EACH(STLSEQ_REGISTRATION, BOOST_PP_EMPTY(), PSANA_PYTHON_ND_TYPES)
+      &psana_python::StlStringVectorToList::register_stlstrvec_to_list_cvt
+    };
+
+#undef STLSEQ_REGISTRATION
+
+  }
 
-    BOOST_PP_SEQ_FOR_EACH(REGISTER_STLLIST_TO_NUMPY_CONVERTER,BOOST_PP_EMPTY(),ND_TYPES)
+  void createConverters() {
+    
+    // Initialise NUMPY 
+    _import_array();
+
+    // Register NDArray <-> NUMPY converters for 1-6 dimensional NDArray,
+    // with data type from int to double, both const and non const
+    for (unsigned i = 0; i != sizeof ndarrayRegistrations / sizeof ndarrayRegistrations[0]; ++ i) {
+      ndarrayRegistrations[i]();
+    }
+
+    // Register the STL vector/deque/list<ndtypes> to Numpy converters with BOOST
+    for (unsigned i = 0; i != sizeof stlseqRegistrations / sizeof stlseqRegistrations[0]; ++ i) {
+      stlseqRegistrations[i]();
+    }
 
     // Register Python-Event to Event converter  
     psana_python::PyEvtToEvt().from_python();
@@ -96,114 +120,6 @@ namespace psana_python {
     
     return;
   }
-
-
-  namespace {
-
-    // type traits for selected set of C++ types that we support as
-    // elements of ndarrays
-    template <typename T> struct Traits {};
-  
-    // ===> SHOULD BE ABLE TO REPLACE THIS WITH BOOST MACROS 
-  
-    // non-const data types
-    template <> struct Traits<int8_t> {
-      static const char* typeName() { return "int8"; }
-      static int numpyType() { return NPY_INT8; }
-    };
-    template <> struct Traits<uint8_t> {
-      static const char* typeName() { return "uint8"; }
-      static int numpyType() { return NPY_UINT8; }
-    };
-    template <> struct Traits<int16_t> {
-      static const char* typeName() { return "int16"; }
-      static int numpyType() { return NPY_INT16; }
-    };
-    template <> struct Traits<uint16_t> {
-      static const char* typeName() { return "uint16"; }
-      static int numpyType() { return NPY_UINT16; }
-    };
-    template <> struct Traits<int32_t> {
-      static const char* typeName() { return "int32"; }
-      static int numpyType() { return NPY_INT32; }
-    };
-    template <> struct Traits<uint32_t> {
-      static const char* typeName() { return "uint32"; }
-      static int numpyType() { return NPY_UINT32; }
-    };
-    template <> struct Traits<int64_t> {
-      static const char* typeName() { return "int64"; }
-      static int numpyType() { return NPY_INT64; }
-    };
-    template <> struct Traits<uint64_t> {
-    static const char* typeName() { return "uint64"; }
-      static int numpyType() { return NPY_UINT64; }
-    };
-    template <> struct Traits<float> {
-      static const char* typeName() { return "float32"; }
-      static int numpyType() { return NPY_FLOAT32; }
-    };
-    template <> struct Traits<double> {
-      static const char* typeName() { return "float64"; }
-      static int numpyType() { return NPY_FLOAT64; }
-    };
-    
-    
-    // const data types
-    template <> struct Traits<const int8_t> {
-      static const char* typeName() { return "int8"; }
-      static int numpyType() { return NPY_INT8; }
-    };
-    template <> struct Traits<const uint8_t> {
-      static const char* typeName() { return "uint8"; }
-      static int numpyType() { return NPY_UINT8; }
-    };
-    template <> struct Traits<const int16_t> {
-      static const char* typeName() { return "int16"; }
-      static int numpyType() { return NPY_INT16; }
-    };
-    template <> struct Traits<const uint16_t> {
-      static const char* typeName() { return "uint16"; }
-      static int numpyType() { return NPY_UINT16; }
-    };
-    template <> struct Traits<const int32_t> {
-      static const char* typeName() { return "int32"; }
-      static int numpyType() { return NPY_INT32; }
-    };
-    template <> struct Traits<const uint32_t> {
-      static const char* typeName() { return "uint32"; }
-      static int numpyType() { return NPY_UINT32; }
-    };
-    template <> struct Traits<const int64_t> {
-      static const char* typeName() { return "int64"; }
-      static int numpyType() { return NPY_INT64; }
-    };
-    template <> struct Traits<const uint64_t> {
-      static const char* typeName() { return "uint64"; }
-      static int numpyType() { return NPY_UINT64; }
-    };
-    template <> struct Traits<const float> {
-      static const char* typeName() { return "float32"; }
-      static int numpyType() { return NPY_FLOAT32; }
-    };
-    template <> struct Traits<const double> {
-      static const char* typeName() { return "float64"; }
-      static int numpyType() { return NPY_FLOAT64; }
-    };
-    
-
-    // Returns true if strides correspond to C memory layout
-    template <unsigned Rank>
-    bool isCArray(const unsigned shape[], const int strides[]) {
-      int stride = 1;
-      for (int i = Rank; i > 0; -- i) {
-	if (strides[i-1] != stride) return false;
-	stride *= shape[i-1];
-      }
-      return true;
-    }
-    
-  }
   
   
     
@@ -213,26 +129,18 @@ namespace psana_python {
   // ***************************************************************************
   // ***************************************************************************
   
-  namespace {
-    // Special Python wrapper object for ndarray
-    template <typename T, unsigned Rank>
-    class NDarrayWrapper : 
-      public pytools::PyDataType<NDarrayWrapper<T, Rank>, ndarray<T, Rank> > {  };
-  }
-
   // NDArray to Numpy converter for BOOST
   template <typename T, unsigned Rank>
   PyObject* NDArrayToNumpy<T,Rank>::convert(ndarray<T, Rank> const& array) 
   {
-    MsgLog(pyConverterlogger, debug, "Calling converter from ndarray<"
-	   << Traits<T>::typeName() << "," << Rank << "> to python object"); 
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger, "Calling converter from ndarray<"
+	   << NdarrayTraits<T>::typeName() << "," << Rank << "> to python object"); 
         
     // item size
     const size_t itemsize = sizeof(T);
     
     // Convert itemsize to numpy type number
-    // For now, use templated function from NdarrayCvt.h
-    const int typenum = Traits<T>::numpyType();
+    const int typenum = NdarrayTraits<T>::numpyType();
     
     // Dimensions and strides 
     npy_intp dims[Rank], strides[Rank];
@@ -265,7 +173,6 @@ namespace psana_python {
     flags |= NPY_ARRAY_WRITEABLE;  
 
     // Check NDArray is C array 
-    // For now, use function from NdarrayCvt.h
     if (psana_python::isCArray<Rank>(array.shape(),array.strides())) {
       flags |= NPY_ARRAY_C_CONTIGUOUS;          
     }
@@ -322,9 +229,11 @@ namespace psana_python {
     // thus if there are multiple copies of the NUMPY array, its
     // reference count will be >0. 
 
-    // Create the python object to keep track of outgoing numpy array
+    // Create the python object to keep track of outgoing numpy array,
+    // wrapper type is shared with event store converters
+    typedef typename boost::remove_const<T>::type ElemType;
     PyObject* numpy_array_tracking_object =
-      NDarrayWrapper<T,Rank>::PyObject_FromCpp(array);
+      NdarrayWrapper<ElemType,Rank>::wrap(ndarray<const ElemType,Rank>(array));
     
     // Set the base pointer of outgoing_numpy_array to
     // numpy_array_tracking_object 
@@ -336,6 +245,9 @@ namespace psana_python {
 			  numpy_array_tracking_object);    
     
 
+    ConverterStats::count(ConverterStats::ToNumpy, typenum, NdarrayTraits<T>::typeName(), Rank,
+                          array.size() * itemsize);
+
     // Now return the outgoing numpy array
     return outgoing_numpy_array;
   }
@@ -351,19 +263,19 @@ namespace psana_python {
     
     if (reg == NULL) {
       MsgLog(pyConverterlogger, debug,
-	     "REGISTER NDARRAY<" << Traits<T>::typeName() << "," << Rank << ">"
+	     "REGISTER NDARRAY<" << NdarrayTraits<T>::typeName() << "," << Rank << ">"
 	     << "TO NUMPY CONVERTER");      
       boost::python::to_python_converter<ndarray<T,Rank>,NDArrayToNumpy<T,Rank> >();
 
     } else if ( (*reg).m_to_python == NULL) {
       MsgLog(pyConverterlogger, debug,
-	     "REGISTER NDARRAY<" << Traits<T>::typeName() << "," << Rank << ">"
+	     "REGISTER NDARRAY<" << NdarrayTraits<T>::typeName() << "," << Rank << ">"
 	     << "TO NUMPY CONVERTER");      
       boost::python::to_python_converter<ndarray<T,Rank>,NDArrayToNumpy<T,Rank> >();
 
     } else {
       MsgLog(pyConverterlogger, debug,
-	     "NDARRAY<" << Traits<T>::typeName() << "," << Rank << ">"
+	     "NDARRAY<" << NdarrayTraits<T>::typeName() << "," << Rank << ">"
 	     << "TO NUMPY CONVERTER ALREADY REGISTERED");
     } 
     
@@ -398,10 +310,12 @@ namespace psana_python {
 
     // For debugging, printing out the contents of the reg pointer will be useful. 
     MsgLog(pyConverterlogger, debug,"reg:" << reg);
-    MsgLog(pyConverterlogger, debug,"reg.m_to_python:" << (*reg).m_to_python);
-    MsgLog(pyConverterlogger, debug,"reg.m_class_object:" << (*reg).m_class_object);
-    MsgLog(pyConverterlogger, debug,"reg.lvalue_chain:" << (*reg).lvalue_chain);
-    MsgLog(pyConverterlogger, debug,"reg.rvalue_chain:" << (*reg).rvalue_chain);
+    if (reg) {
+      MsgLog(pyConverterlogger, debug,"reg.m_to_python:" << (*reg).m_to_python);
+      MsgLog(pyConverterlogger, debug,"reg.m_class_object:" << (*reg).m_class_object);
+      MsgLog(pyConverterlogger, debug,"reg.lvalue_chain:" << (*reg).lvalue_chain);
+      MsgLog(pyConverterlogger, debug,"reg.rvalue_chain:" << (*reg).rvalue_chain);
+    }
         
     if (reg == NULL) {
       boost::python::converter::registry::push_back(&NumpyToNDArray::convertible,
@@ -409,7 +323,7 @@ namespace psana_python {
 						    boost::python::type_id< ndarray<T, Rank>  >() );    
       MsgLog(pyConverterlogger, debug,
 	     "REGISTER BOOST PYTHON converter for NUMPY to NDARRAY"
-	     << "<" << Traits<T>::typeName() << "," << Rank << ">");  
+	     << "<" << NdarrayTraits<T>::typeName() << "," << Rank << ">");  
 
     } else if ((*reg).rvalue_chain == NULL && (*reg).lvalue_chain == NULL) {
       boost::python::converter::registry::push_back(&NumpyToNDArray::convertible,
@@ -417,14 +331,14 @@ namespace psana_python {
 						    boost::python::type_id< ndarray<T, Rank>  >() );
       MsgLog(pyConverterlogger, debug,
 	     "REGISTER BOOST PYTHON converter for NUMPY to NDARRAY"
-	     << "<" << Traits<T>::typeName() << "," << Rank << ">");  
+	     << "<" << NdarrayTraits<T>::typeName() << "," << Rank << ">");  
       // NB:When Numpy-->NDArray converter is missing, both rvalue_chain and lvalue_chain are NULL
       // NB: the rvalue and lvalue was only checked emperically. So could be incorrect...
       
     } else {
       MsgLog(pyConverterlogger, debug,
 	     "BOOST PYTHON converter for NUMPY to NDARRAY"
-	     << "<" << Traits<T>::typeName() << "," << Rank << "> ALREADY REGISTERED"); 	    
+	     << "<" << NdarrayTraits<T>::typeName() << "," << Rank << "> ALREADY REGISTERED"); 	    
     } 
     
     return *this;
@@ -435,32 +349,35 @@ namespace psana_python {
   template <typename T, unsigned Rank> 
   void* NumpyToNDArray<T,Rank>::convertible(PyObject* obj) 
   {
-    MsgLog(pyConverterlogger, debug,"CHECKING PYTHON OBJECT IS A NUMPY ARRAY");
-    MsgLog(pyConverterlogger, debug,
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"CHECKING PYTHON OBJECT IS A NUMPY ARRAY");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
 	   "Value from PyArray_Check " << PyArray_Check(obj) );
 
     if ( !PyArray_Check(obj) ) {
-      MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS NOT A NUMPY ARRAY");
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS NOT A NUMPY ARRAY");
+      ConverterStats::reject(ConverterStats::NotArray);
       return NULL;
      }
 
     PyArrayObject* arrayPtr = reinterpret_cast<PyArrayObject*>(obj);
     const int rank = PyArray_NDIM(arrayPtr);
     if (rank != Rank) {
-      MsgLog(pyConverterlogger, debug,
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
 	     "INCORRECT NUMBER OF DIMENSIONS. Expected:" << Rank << " Got:" << rank);
+      ConverterStats::reject(ConverterStats::WrongRank);
       return NULL;
     }
 
-    if (Traits<T>::numpyType() != PyArray_TYPE(arrayPtr)) {
-      MsgLog(pyConverterlogger, debug,
-	     "INCORRECT TYPE.  Expected " << Traits<T>::typeName()
+    if (NdarrayTraits<T>::numpyType() != PyArray_TYPE(arrayPtr)) {
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
+	     "INCORRECT TYPE.  Expected " << NdarrayTraits<T>::typeName()
 	     << " Got:" << PyArray_TYPE(arrayPtr));
+      ConverterStats::reject(ConverterStats::WrongType);
       return NULL;
     }
 
-    MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS A NUMPY ARRAY");
-    MsgLog(pyConverterlogger, debug,"Leaving convertible");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS A NUMPY ARRAY");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Leaving convertible");
     return obj;
   }
 
@@ -491,6 +408,16 @@ namespace psana_python {
       strides[i] = PyArray_STRIDE(arrayPtr,i)/itemsize;
     }
 
+    // The outgoing NDArray shares data with NUMPY array and holds a
+    // reference to it, so the data stays valid for as long as any copy
+    // of the NDArray exists in C++, even after PYTHON drops the array.
+    // The reference is released with GIL taken, whichever thread
+    // destroys the last copy. This is the same scheme as used by
+    // Ndarray2CppCvt for arrays stored in the event.
+    Py_INCREF(obj);
+    boost::shared_ptr<PyObject> owner(obj, PyObjectReleaser());
+    boost::shared_ptr<T> data(owner, array);
+
     // Now that we have created out outgoing NDAraay, tell BOOST about
     // it, so it can pass it onto the calling C++ function
          
@@ -503,31 +430,17 @@ namespace psana_python {
     void* storage = reinterpret_cast<storagetype*> (boostData)->storage.bytes;
 
     // --> Now set data's convertible attribute to outgoing NDArray
-    MsgLog(pyConverterlogger, debug,"Creating outgoing ndarray");
-    boostData->convertible = new(storage) ndarray<T,Rank>(array,shape);
-
-    // NB: NDARRAY is created with a raw pointer.  That means NDARRAY
-    // is not responsible for the memory, which is good in that the
-    // calling C/C++ function cannot delete the data underneath NUMPY.
-    // BUT if the NUMPY array goes out of scope in PYTHON, and the
-    // calling C/C++ function still retains a reference to it, PYTHON
-    // will delete the array data, and the C/C++ will be crash when
-    // the C/C++ dereferences it.
-
-    // Thus these converters should only be used for C/C++ functions 
-    // that have no object persistance; ie:- PSALG functions are fine. 
-    
-    // For future thought.  If the NDArray constructor and destructor
-    // could increment and decrement the PYTHON reference count, respectively,
-    // via some intermediate object, this would allow robust memory-safe BOOST
-    // converters with persistant objects. 
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Creating outgoing ndarray");
+    boostData->convertible = new(storage) ndarray<T,Rank>(data,shape);
 
-    
     // Set the strides of the outgoing NDArray
     ndarray<T,Rank>* outgoingArray = reinterpret_cast<ndarray<T,Rank>*>(boostData->convertible);
     outgoingArray->strides(strides);
 
-    MsgLog(pyConverterlogger, debug,
+    ConverterStats::count(ConverterStats::FromNumpy, NdarrayTraits<T>::numpyType(), NdarrayTraits<T>::typeName(),
+                          Rank, PyArray_NBYTES(arrayPtr));
+
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
 	   "Address of orignal Numpy data " << array);
     return;
   }
@@ -544,84 +457,162 @@ namespace psana_python {
   
   // ***************************************************************************
   // ***************************************************************************
-  //    START OF STL-LIST<NUMBERS> TO NUMPY CONVERTER
+  //    START OF STL-SEQUENCE TO NUMPY CONVERTER
   // ***************************************************************************
   // ***************************************************************************
-  
-  // stl::list<ndtypes> to Numpy converter for BOOST
-  // where ndtypes is defined by macro ND_TYPES defined at top of this header
-  template <typename T>
-  PyObject* StlListToNumpy<T>::convert( std::list<T> const& list ) 
+
+  namespace {
+
+    // Element traits for sequence converters, describe Numpy dtype of array
+    // elements and how to copy elements into Numpy data
+    template <typename T> struct SeqElement {
+
+      static std::string name() { return NdarrayTraits<T>::typeName(); }
+
+      // returns new reference
+      template <typename Container>
+      static PyArray_Descr* descr(Container const&) { return PyArray_DescrFromType(NdarrayTraits<T>::numpyType()); }
+
+      template <typename Container>
+      static void copy(Container const& seq, char* data, size_t) {
+        // for vector this is a single memmove
+        std::copy(seq.begin(), seq.end(), reinterpret_cast<T*>(data));
+      }
+    };
+
+    // pairs become structured array with the same memory layout as std::pair
+    template <typename T> struct SeqElement<std::pair<T, T> > {
+
+      typedef std::pair<T, T> Pair;
+
+      static std::string name() { return std::string("pair<") + NdarrayTraits<T>::typeName() + ">"; }
+
+      template <typename Container>
+      static PyArray_Descr* descr(Container const&) {
+        Pair pair;
+        const char* base = reinterpret_cast<const char*>(&pair);
+        PyObject* spec = Py_BuildValue("{s:[ss],s:[NN],s:[nn],s:n}",
+            "names", "first", "second",
+            "formats", PyArray_DescrFromType(NdarrayTraits<T>::numpyType()), PyArray_DescrFromType(NdarrayTraits<T>::numpyType()),
+            "offsets", Py_ssize_t(reinterpret_cast<const char*>(&pair.first) - base),
+                       Py_ssize_t(reinterpret_cast<const char*>(&pair.second) - base),
+            "itemsize", Py_ssize_t(sizeof(Pair)));
+        if (not spec) return 0;
+        PyArray_Descr* descr = 0;
+        PyArray_DescrConverter(spec, &descr);
+        Py_DECREF(spec);
+        return descr;
+      }
+
+      template <typename Container>
+      static void copy(Container const& seq, char* data, size_t) {
+        std::copy(seq.begin(), seq.end(), reinterpret_cast<Pair*>(data));
+      }
+    };
+
+    template <typename Container> struct SeqName {};
+    template <typename T> struct SeqName<std::vector<T> > {
+      static std::string name() { return "STL VECTOR<" + SeqElement<T>::name() + ">"; }
+    };
+    template <typename T> struct SeqName<std::deque<T> > {
+      static std::string name() { return "STL DEQUE<" + SeqElement<T>::name() + ">"; }
+    };
+    template <typename T> struct SeqName<std::list<T> > {
+      static std::string name() { return "STL LIST<" + SeqElement<T>::name() + ">"; }
+    };
+
+  }
+
+  // STL sequence to Numpy converter for BOOST
+  template <typename Container>
+  PyObject* StlSeqToNumpy<Container>::convert( Container const& seq )
   {
-    MsgLog(pyConverterlogger, debug,
-	   "Calling converter from stl::list<" 
-	   <<  Traits<T>::typeName() << "> to python object");  
-            
-    // Convert itemsize to numpy type number    
-    const int typenum = Traits<T>::numpyType();
-    
-    // Numpy array shape is set to be 1D and same size as list
+    typedef SeqElement<typename Container::value_type> Element;
+
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
+           "Calling converter from " << SeqName<Container>::name() << " of size "
+           << seq.size() << " to python object");
+
+    // Numpy array shape is set to be 1D and same size as sequence
     npy_intp dims[1];
-    dims[0] = list.size();
-            
-    // Create a 1D numpy array that has same size as the list            
-    PyObject* outgoing_numpy_array = PyArray_SimpleNew(1,dims,typenum);
-    
-    // Recast outgoing_numpy_array as PyArrayObject* to get access to data
-    PyArrayObject* aoptr_outgoing_numpy_array =
-      reinterpret_cast<PyArrayObject*>(outgoing_numpy_array);
-      
-    // Get pointer to underlying numpy array
-    T* arrayData = reinterpret_cast<T*>(PyArray_DATA(aoptr_outgoing_numpy_array));
-          
-    // Deep copy contents of list to outgoing_numpy_array 
-    // ...also avoids problems associated with lifetime of numpy and stl list
-    typename std::list<T>::const_iterator listIter;
-    for(listIter = list.begin(); listIter != list.end(); listIter++,arrayData++) 
-      {
-	MsgLog(pyConverterlogger, debug, *listIter);
-	*arrayData = *listIter;
-      }
+    dims[0] = seq.size();
+
+    // PyArray_Zeros steals reference to descr
+    PyArray_Descr* descr = Element::descr(seq);
+    if (not descr) return 0;
+    PyObject* outgoing_numpy_array = PyArray_Zeros(1, dims, descr, 0);
+    if (not outgoing_numpy_array) return 0;
+
+    // Deep copy contents of sequence to outgoing_numpy_array, boost gives
+    // us a const reference so there is nothing that could be moved
+    PyArrayObject* aoptr_outgoing_numpy_array = reinterpret_cast<PyArrayObject*>(outgoing_numpy_array);
+    Element::copy(seq, reinterpret_cast<char*>(PyArray_DATA(aoptr_outgoing_numpy_array)),
+                  PyArray_ITEMSIZE(aoptr_outgoing_numpy_array));
+    ConverterStats::countCopy(PyArray_NBYTES(aoptr_outgoing_numpy_array));
 
-    
     // Now return the outgoing numpy array
     return outgoing_numpy_array;
   }
-  
 
 
-  // Register STL list<number> to Numpy converter with BOOST
-  template <typename T>
-  void StlListToNumpy<T>::register_stllist_to_numpy_cvt() 
+
+  // Register STL sequence to Numpy converter with BOOST
+  template <typename Container>
+  void StlSeqToNumpy<Container>::register_stlseq_to_numpy_cvt()
   {
     // Check if converter already registered for this type
-    boost::python::type_info tinfo = boost::python::type_id< std::list<T> >();
+    boost::python::type_info tinfo = boost::python::type_id<Container>();
     boost::python::converter::registration const* reg = boost::python::converter::registry::query(tinfo);
-    
-    if (reg == NULL) {
-      MsgLog(pyConverterlogger, debug,
-	     "REGISTER STL LIST<" << Traits<T>::typeName() << ">"
-	     << "TO NUMPY CONVERTER");
-      boost::python::to_python_converter< std::list<T>, StlListToNumpy<T> >();
 
-    } else if ( (*reg).m_to_python == NULL) {
+    if (reg == NULL or (*reg).m_to_python == NULL) {
       MsgLog(pyConverterlogger, debug,
-	     "REGISTER STL LIST<" << Traits<T>::typeName() << ">"
-	     << "TO NUMPY CONVERTER");
-      boost::python::to_python_converter< std::list<T>, StlListToNumpy<T> >();
-
+             "REGISTER " << SeqName<Container>::name() << " TO NUMPY CONVERTER");
+      boost::python::to_python_converter< Container, StlSeqToNumpy<Container> >();
     } else {
       MsgLog(pyConverterlogger, debug,
-	     "STL LIST<" << Traits<T>::typeName() << ">"
-	     << "TO NUMPY CONVERTER ALREADY REGISTERED");
-    } 
-    
-    return;
+             SeqName<Container>::name() << " TO NUMPY CONVERTER ALREADY REGISTERED");
+    }
+  }
+
+
+
+  // STL vector<string> to Python list of str converter for BOOST
+  PyObject* StlStringVectorToList::convert( std::vector<std::string> const& seq )
+  {
+    PyObject* list = PyList_New(seq.size());
+    if (not list) return 0;
+    for (size_t i = 0; i != seq.size(); ++ i) {
+#ifdef IS_PY3K
+      PyObject* str = PyUnicode_FromStringAndSize(seq[i].data(), seq[i].size());
+#else
+      PyObject* str = PyString_FromStringAndSize(seq[i].data(), seq[i].size());
+#endif
+      if (not str) {
+        Py_DECREF(list);
+        return 0;
+      }
+      PyList_SET_ITEM(list, i, str);
+    }
+    return list;
+  }
+
+  // Register STL vector<string> to Python list converter with BOOST
+  void StlStringVectorToList::register_stlstrvec_to_list_cvt()
+  {
+    boost::python::type_info tinfo = boost::python::type_id<std::vector<std::string> >();
+    boost::python::converter::registration const* reg = boost::python::converter::registry::query(tinfo);
+
+    if (reg == NULL or (*reg).m_to_python == NULL) {
+      MsgLog(pyConverterlogger, debug, "REGISTER STL VECTOR<string> TO LIST CONVERTER");
+      boost::python::to_python_converter< std::vector<std::string>, StlStringVectorToList >();
+    } else {
+      MsgLog(pyConverterlogger, debug, "STL VECTOR<string> TO LIST CONVERTER ALREADY REGISTERED");
+    }
   }
 
 // ***************************************************************************
 // ***************************************************************************
-//    END OF STL-LIST<NUMBERS> TO NDARRAY CONVERTER
+//    END OF STL-SEQUENCE TO NUMPY CONVERTER
 // ***************************************************************************
 // ***************************************************************************
 
@@ -670,16 +661,17 @@ namespace psana_python {
   // Check object can be converted
   void* PyEvtToEvt::convertible(PyObject* obj) 
   {
-    MsgLog(pyConverterlogger, debug,"CHECKING PYTHON OBJECT IS A PYTHON-EVENT");
-    MsgLog(pyConverterlogger, debug,"Pyobject type " << obj->ob_type->tp_name );
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"CHECKING PYTHON OBJECT IS A PYTHON-EVENT");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Pyobject type " << obj->ob_type->tp_name );
 
     if (!psana_python::Event::Object_TypeCheck(obj)) {
-      MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS NOT A PSANA EVENT");
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS NOT A PSANA EVENT");
+      ConverterStats::reject(ConverterStats::WrongObject);
       return NULL;
      }
 
-    MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS A PSANA EVENT");
-    MsgLog(pyConverterlogger, debug,"Leaving convertible");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS A PSANA EVENT");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Leaving convertible");
     return obj;
   }
 
@@ -694,7 +686,7 @@ namespace psana_python {
     //  --->  typedef boost::python::converter::rvalue_from_python_stage1_data BoostData;
 
     // --> Set boostData's convertible attribute to point to the original PSANA Event object
-    MsgLog(pyConverterlogger, debug,"Pointing back to original PSANA Event Object");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Pointing back to original PSANA Event Object");
 
     // NB: WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER. WE
     // ASSUME THAT BOOST PASSES THE SMART POINTER BY VALUE WHEN
@@ -702,8 +694,8 @@ namespace psana_python {
     // REFERENCE COUNT
     // (PYTHON CANNOT DELETE THE SHARED POINTER WHILE THIS HAPPENS)
 
-    MsgLog(pyConverterlogger, debug,
-	   " WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER")
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
+	   " WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER");
     psana_python::Event* py_this = static_cast<psana_python::Event*>(obj);
     boostData->convertible = static_cast<void*> (&(py_this->m_obj));
 
@@ -760,16 +752,17 @@ namespace psana_python {
   // Check object can be converted
   void* PyEnvToEnv::convertible(PyObject* obj) 
   {
-    MsgLog(pyConverterlogger, debug,"CHECKING PYTHON OBJECT IS A PYTHON-ENV");
-    MsgLog(pyConverterlogger, debug,"Pyobject type " << obj->ob_type->tp_name );
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"CHECKING PYTHON OBJECT IS A PYTHON-ENV");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Pyobject type " << obj->ob_type->tp_name );
 
     if (!psana_python::Env::Object_TypeCheck(obj)) {
-      MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS NOT A PSANA ENV");
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS NOT A PSANA ENV");
+      ConverterStats::reject(ConverterStats::WrongObject);
       return NULL;
      }
 
-    MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS A PSANA ENV");
-    MsgLog(pyConverterlogger, debug,"Leaving convertible");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS A PSANA ENV");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Leaving convertible");
     return obj;
   }
 
@@ -784,7 +777,7 @@ namespace psana_python {
     //  --->  typedef boost::python::converter::rvalue_from_python_stage1_data BoostData;
 
     // --> Set boostData's convertible attribute to point to the original PSANA Env object
-    MsgLog(pyConverterlogger, debug,"Pointing back to original PSANA Env Object");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Pointing back to original PSANA Env Object");
 
 
     // NB: WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER. WE
@@ -792,8 +785,8 @@ namespace psana_python {
     // CALLING THE C++ FUNCTION, THUS INCREMENTING THE SHARED POINTER
     // REFERENCE COUNT
     // (PYTHON CANNOT DELETE THE SHARED POINTER WHILE THIS HAPPENS)
-    MsgLog(pyConverterlogger, debug,
-	   " WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER")      
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,
+	   " WE ARE GIVING BOOST A REFERENCE TO A SMART POINTER");
     psana_python::Env* py_this = static_cast<psana_python::Env*>(obj);
     boostData->convertible = static_cast<void*> (&(py_this->m_obj));
 
@@ -850,15 +843,16 @@ namespace psana_python {
   // Check object can be converted
   void* PySourceToSource::convertible(PyObject* obj) 
   {
-    MsgLog(pyConverterlogger, debug,"CHECKING PYTHON OBJECT IS A PYTHON-SOURCE");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"CHECKING PYTHON OBJECT IS A PYTHON-SOURCE");
 
     if (!psana_python::Source::Object_TypeCheck(obj) ) {
-      MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS NOT A PSANA SOURCE");
+      PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS NOT A PSANA SOURCE");
+      ConverterStats::reject(ConverterStats::WrongObject);
       return NULL;
     }
 
-    MsgLog(pyConverterlogger, debug,"PYTHON OBJECT IS A PSANA SOURCE");
-    MsgLog(pyConverterlogger, debug,"Leaving convertible");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"PYTHON OBJECT IS A PSANA SOURCE");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Leaving convertible");
     return obj;
   }
 
@@ -873,7 +867,7 @@ namespace psana_python {
     //  --->  typedef boost::python::converter::rvalue_from_python_stage1_data BoostData;
 
     // --> Set boostData's convertible attribute to point to the original PSANA Source object
-    MsgLog(pyConverterlogger, debug,"Pointing back to original PSANA Source Object");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Pointing back to original PSANA Source Object");
 
     psana_python::Source* py_this = static_cast<psana_python::Source*>(obj);
     
@@ -887,7 +881,7 @@ namespace psana_python {
     void* storage = reinterpret_cast<storagetype*> (boostData)->storage.bytes;
 
     // --> Now set data's convertible attribute to outgoing CPP-SOURCE
-    MsgLog(pyConverterlogger, debug,"Creating outgoing CPP-SOURCE");
+    PSANA_PYTHON_CVT_TRACE(pyConverterlogger,"Creating outgoing CPP-SOURCE");
     boostData->convertible = new(storage) PSEvt::Source(py_this->m_obj);
 
     return;